@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+
+// Build options for heap allocation instrumentation:
+//-- EXPERIS_TRACK_ALLOCATIONS replaces the global operator new/delete and counts every allocation per thread
+//-- EXPERIS_ASSERT_NO_ALLOC also aborts when anything allocates inside a no-alloc scope, and implies tracking
+//-- the replacements are defined in this header, so only the translation unit holding main() may enable either option
+#if defined(EXPERIS_ASSERT_NO_ALLOC) && !defined(EXPERIS_TRACK_ALLOCATIONS)
+#define EXPERIS_TRACK_ALLOCATIONS
+#endif
+
+namespace ExperisBowling {
+    // allocations made by one thread, either since it started or across a scope
+    struct AllocationStats {
+        size_t  count   = 0u;   // calls to operator new
+        size_t  bytes   = 0u;   // bytes requested by those calls
+    };
+
+    // per-thread allocation bookkeeping, so parallel loops don't blame each other's allocations
+    struct AllocationTracker {
+        static inline thread_local AllocationStats  stats           = {};
+        static inline thread_local unsigned         noAllocDepth    = 0u;   // nesting of the active no-alloc scopes
+
+        static constexpr bool IsEnabled() {
+#if defined(EXPERIS_TRACK_ALLOCATIONS)
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        static void Record(size_t size) {
+            stats.count++;
+            stats.bytes += size;
+#if defined(EXPERIS_ASSERT_NO_ALLOC)
+            if (noAllocDepth > 0u) {
+                // anything fancier than fputs could allocate again
+                std::fputs("Heap allocation inside a no-alloc scope\n", stderr);
+                std::abort();
+            }
+#endif
+        }
+    };
+
+    // Measures the allocations the current thread makes while the counter is alive.
+    //-- reports nothing unless tracking is enabled
+    class AllocationCounter {
+    private:
+        AllocationStats start = AllocationTracker::stats;
+
+    public:
+        AllocationStats GetStats() const {
+            AllocationStats const& now = AllocationTracker::stats;
+            return { now.count - start.count, now.bytes - start.bytes };
+        }
+    };
+
+    // Marks a section that must never touch the heap, such as scoring a valid roll.
+    //-- safe to use in constexpr code, constant evaluation can't allocate behind our back anyway
+    class NoAllocScope {
+    public:
+        constexpr NoAllocScope() {
+            if (!std::is_constant_evaluated()) {
+                AllocationTracker::noAllocDepth++;
+            }
+        }
+
+        constexpr ~NoAllocScope() {
+            if (!std::is_constant_evaluated()) {
+                AllocationTracker::noAllocDepth--;
+            }
+        }
+
+        NoAllocScope(NoAllocScope const&) = delete;
+        NoAllocScope& operator=(NoAllocScope const&) = delete;
+    };
+} // namespace ExperisBowling
+
+// opens a no-alloc scope until the end of the enclosing block, compiled out unless the assert mode is on
+#if defined(EXPERIS_ASSERT_NO_ALLOC)
+#define EXPERIS_NO_ALLOC_SCOPE() ::ExperisBowling::NoAllocScope const experisNoAllocScope
+#else
+#define EXPERIS_NO_ALLOC_SCOPE() static_cast<void>(0)
+#endif
+
+#if defined(EXPERIS_TRACK_ALLOCATIONS)
+// the array, nothrow and sized forms all forward to these by default
+void* operator new(size_t size) {
+    ExperisBowling::AllocationTracker::Record(size);
+    if (void* memory = std::malloc(size == 0u ? 1u : size)) {
+        return memory;
+    }
+
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    ExperisBowling::AllocationTracker::Record(size);
+    size_t const align = static_cast<size_t>(alignment);
+#if defined(_MSC_VER)
+    void* memory = _aligned_malloc(size == 0u ? 1u : size, align);
+#else
+    // aligned_alloc wants the size rounded up to a multiple of the alignment
+    void* memory = std::aligned_alloc(align, (size + align - 1u) / align * align + (size == 0u ? align : 0u));
+#endif
+    if (memory != nullptr) {
+        return memory;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept {
+#if defined(_MSC_VER)
+    _aligned_free(memory);
+#else
+    std::free(memory);
+#endif
+}
+
+void operator delete(void* memory, size_t, std::align_val_t alignment) noexcept {
+    operator delete(memory, alignment);
+}
+#endif
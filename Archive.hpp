@@ -0,0 +1,78 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
+#include "Game.hpp"
+#include "RollNotation.hpp"
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace ExperisBowling {
+    // anything that can hand out the roll sequences of archived games by index
+    //-- archives that store rolls in another encoding decode them into the given buffer
+    template <class T>
+    concept GameArchive = requires(T const& archive, size_t index, std::span<std::uint8_t, Game::MaxRolls + 1u> buffer) {
+        { archive.GetGameCount() } -> std::convertible_to<size_t>;
+        { archive.GetGameRolls(index, buffer) } -> std::convertible_to<std::span<const std::uint8_t>>;
+    };
+
+    // An archive of games held in memory as one flat array of pin counts.
+    class RollSequenceArchive {
+    private:
+        std::vector<std::uint8_t>   rolls;
+        std::vector<size_t>         gameStarts = { 0u };    // index of each game's first roll, plus the end of the last game
+
+    public:
+        void AddGame(std::span<const std::uint8_t> gameRolls) {
+            rolls.insert(rolls.end(), gameRolls.begin(), gameRolls.end());
+            gameStarts.push_back(rolls.size());
+        }
+
+        size_t GetGameCount() const {
+            return gameStarts.size() - 1u;
+        }
+
+        std::span<const std::uint8_t> GetGameRolls(size_t index, std::span<std::uint8_t, Game::MaxRolls + 1u>) const {
+            return std::span(rolls).subspan(gameStarts[index], gameStarts[index + 1u] - gameStarts[index]);
+        }
+    };
+
+    // reads a text archive with one game per line, rolls written in scoreboard notation and separated by spaces or commas
+    //-- unreadable rolls are stored as an impossible pin count so the game is reported as invalid instead of dropped
+    inline RollSequenceArchive ReadTextArchive(std::string_view text) {
+        static constexpr std::uint8_t UnreadableRoll = Game::NumPins + 1u;
+
+        RollSequenceArchive archive;
+        std::vector<std::uint8_t> gameRolls;
+        RollNotationParser parser;
+
+        while (!text.empty()) {
+            size_t const lineEnd = std::min(text.find('\n'), text.size());
+            std::string_view line = text.substr(0u, lineEnd);
+            text.remove_prefix(std::min(lineEnd + 1u, text.size()));
+
+            gameRolls.clear();
+            parser.Reset();
+            while (true) {
+                size_t const tokenStart = line.find_first_not_of(" \t\r,");
+                if (tokenStart == std::string_view::npos) {
+                    break;
+                }
+                line.remove_prefix(tokenStart);
+
+                size_t const tokenEnd = std::min(line.find_first_of(" \t\r,"), line.size());
+                std::optional<unsigned> const pins = parser.Parse(line.substr(0u, tokenEnd));
+                gameRolls.push_back(static_cast<std::uint8_t>(std::min(pins.value_or(UnreadableRoll), unsigned{ UnreadableRoll })));
+                line.remove_prefix(tokenEnd);
+            }
+
+            if (!gameRolls.empty()) { // skip blank lines
+                archive.AddGame(gameRolls);
+            }
+        }
+
+        return archive;
+    }
+} // namespace ExperisBowling
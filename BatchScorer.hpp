@@ -0,0 +1,121 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include "Game.hpp"
+#include <optional>
+#include <span>
+
+namespace ExperisBowling {
+    // Scores a group of complete games at once, one game per lane.
+    //-- data is stored struct-of-arrays and every step is a branch-free loop over the lanes, so the compiler
+    //-- turns each lane loop into AVX2/AVX-512/NEON vector code without any per-target intrinsics
+    //-- the lane count should be a multiple of the vector width, e.g. 32 byte lanes fill an AVX2 register
+    template <size_t LaneCount = 32u>
+    class BatchScorer {
+    public:
+        static constexpr size_t Lanes = LaneCount;
+
+        // rolls for a group of games, stored roll-major so each lane loop reads contiguous memory
+        struct Rolls {
+            // two extra rows of zeros let the bonus lookahead of the final frame stay inside the array
+            std::array<std::array<std::uint8_t, LaneCount>, Game::MaxRolls + 2u>    pins{};
+            std::array<std::uint8_t, LaneCount>                                     rollCounts{};
+
+            // copies a game's rolls into a lane - games with too many rolls are kept as invalid
+            constexpr void SetGame(size_t lane, std::span<const std::uint8_t> rolls) {
+                for (size_t i = 0u; i < pins.size(); i++) {
+                    pins[i][lane] = i < rolls.size() && i < Game::MaxRolls ? rolls[i] : 0u;
+                }
+                rollCounts[lane] = static_cast<std::uint8_t>(std::min<size_t>(rolls.size(), Game::MaxRolls + 1u));
+            }
+        };
+
+        // per-frame results for a group of games, matching Game::Frame::currentScore and totalScore
+        struct Scores {
+            std::array<std::array<std::uint8_t, LaneCount>, Game::FinalFrame>     currentScore{};
+            std::array<std::array<std::uint16_t, LaneCount>, Game::FinalFrame>    totalScore{};
+            std::array<std::uint8_t, LaneCount>                                   isValid{};      // 1 if the lane held a complete, legal game
+        };
+
+        // scores every lane, marking lanes that don't hold a complete game as invalid
+        static constexpr void Score(Rolls const& rolls, Scores& scores) {
+            std::array<std::uint8_t, LaneCount>     position{};     // index of the first roll of the current frame
+            std::array<std::uint16_t, LaneCount>    runningTotal{};
+            std::array<std::uint8_t, LaneCount>     isValid;
+            std::array<std::uint8_t, LaneCount>     firstRoll;
+            std::array<std::uint8_t, LaneCount>     secondRoll;
+            std::array<std::uint8_t, LaneCount>     thirdRoll;
+            isValid.fill(1u);
+
+            for (unsigned frame = 0u; frame < Game::FinalFrame; frame++) {
+                firstRoll.fill(0u);
+                secondRoll.fill(0u);
+                thirdRoll.fill(0u);
+
+                // a frame can only start between roll `frame` (all strikes) and roll `2 * frame` (no strikes),
+                // so select its rolls from those few rows with masks instead of a per-lane gather
+                for (unsigned start = frame; start <= 2u * frame; start++) {
+                    for (size_t lane = 0u; lane < LaneCount; lane++) {
+                        std::uint8_t const mask = position[lane] == start ? 0xFFu : 0u;
+                        firstRoll[lane] |= rolls.pins[start][lane] & mask;
+                        secondRoll[lane] |= rolls.pins[start + 1u][lane] & mask;
+                        thirdRoll[lane] |= rolls.pins[start + 2u][lane] & mask;
+                    }
+                }
+
+                // flags are kept as 0/1 integers and combined bitwise so the loop stays branch-free
+                for (size_t lane = 0u; lane < LaneCount; lane++) {
+                    unsigned const first = firstRoll[lane];
+                    unsigned const second = secondRoll[lane];
+                    unsigned const isStrike = first == Game::NumPins;
+                    unsigned const isSpare = (1u - isStrike) & (first + second == Game::NumPins);
+                    unsigned const score = first + second + thirdRoll[lane] * (isStrike | isSpare);
+
+                    isValid[lane] &= static_cast<std::uint8_t>((first <= Game::NumPins) & (isStrike | (first + second <= Game::NumPins)));
+                    runningTotal[lane] = static_cast<std::uint16_t>(runningTotal[lane] + score);
+                    scores.currentScore[frame][lane] = static_cast<std::uint8_t>(score);
+                    scores.totalScore[frame][lane] = runningTotal[lane];
+                    position[lane] = static_cast<std::uint8_t>(position[lane] + 2u - isStrike);
+                }
+            }
+
+            // the final frame's bonus rolls must be real pin counts, and nothing may follow them
+            for (size_t lane = 0u; lane < LaneCount; lane++) {
+                unsigned const first = firstRoll[lane];
+                unsigned const second = secondRoll[lane];
+                unsigned const isStrike = first == Game::NumPins;
+                unsigned const isSpare = (1u - isStrike) & (first + second == Game::NumPins);
+                unsigned const bonusRolls = isStrike * Game::StrikeBonusRolls + isSpare * Game::SpareBonusRolls;
+
+                isValid[lane] &= static_cast<std::uint8_t>(((1u - isStrike) | (second <= Game::NumPins)) & (thirdRoll[lane] <= Game::NumPins));
+                isValid[lane] &= static_cast<std::uint8_t>((1u - isStrike) | (second == Game::NumPins) | (second + thirdRoll[lane] <= Game::NumPins)); // the second bonus roll only gets fresh pins after a strike
+                isValid[lane] &= static_cast<std::uint8_t>(position[lane] + bonusRolls == rolls.rollCounts[lane]);
+            }
+
+            scores.isValid = isValid;
+        }
+
+        // checks one lane against the scalar engine scoring the same rolls, for cross-checking the kernel
+        static constexpr bool MatchesGame(Scores const& scores, size_t lane, std::span<const std::uint8_t> rolls) {
+            std::optional<Game> const game = Game::FromRolls(rolls);
+            bool const isComplete = game && game->IsGameComplete();
+            if ((scores.isValid[lane] != 0u) != isComplete) {
+                return false;
+            }
+            if (!isComplete) { // scores of invalid lanes are meaningless
+                return true;
+            }
+
+            for (unsigned frame = 0u; frame < Game::FinalFrame; frame++) {
+                Game::Frame const gameFrame = game->GetFrame(frame);
+                if (scores.currentScore[frame][lane] != gameFrame.currentScore || scores.totalScore[frame][lane] != gameFrame.totalScore) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+    };
+} // namespace ExperisBowling
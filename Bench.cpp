@@ -0,0 +1,572 @@
+// the benchmarks always count allocations, whatever the build configuration
+#if !defined(EXPERIS_TRACK_ALLOCATIONS)
+#define EXPERIS_TRACK_ALLOCATIONS
+#endif
+
+#include "AllocTracking.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <format>
+#include "FrameExport.hpp"
+#include "Game.hpp"
+#include "GameValidation.hpp"
+#include <iostream>
+#include <memory>
+#include <optional>
+#include "OutcomeSimulator.hpp"
+#include <random>
+#include "Rescore.hpp"
+#include "RollIngest.hpp"
+#include "RollJournal.hpp"
+#include "ScoreBoard.hpp"
+#include "ScoringProtocol.hpp"
+#include "ScoringTables.hpp"
+#include "SeasonStandings.hpp"
+#include "ShardRouting.hpp"
+#include <span>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace ExperisBowling;
+
+// keeps the optimizer from discarding a result the benchmark never otherwise reads
+template <class T>
+static void KeepAlive(T const& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile char sink;
+    sink = *reinterpret_cast<char const volatile*>(&value);
+#endif
+}
+
+// Times a benchmark body, growing the iteration count until a run is long enough to measure reliably.
+//-- each call to the body performs opsPerIteration operations, which is what every per-op figure is reported against
+template <class Body>
+static void RunBenchmark(std::string_view name, size_t opsPerIteration, Body&& body) {
+    using Clock = std::chrono::steady_clock;
+    static constexpr auto MinDuration = std::chrono::milliseconds(200);
+
+    size_t iterations = 1u;
+    while (true) {
+        AllocationCounter const counter;
+        Clock::time_point const start = Clock::now();
+        for (size_t i = 0u; i < iterations; i++) {
+            body();
+        }
+        Clock::duration const elapsed = Clock::now() - start;
+        AllocationStats const allocations = counter.GetStats();
+
+        if (elapsed >= MinDuration) {
+            double const ops = static_cast<double>(iterations * opsPerIteration);
+            double const nanoseconds = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+            std::cout << std::format("{:<36}{:>12.2f}{:>14.2f}{:>14.2f}\n", name, nanoseconds / ops,
+                static_cast<double>(allocations.count) / ops, static_cast<double>(allocations.bytes) / ops);
+            return;
+        }
+
+        iterations *= 2u;
+    }
+}
+
+// a stream buffer that takes everything written to it and keeps none of it, so exports are timed without the disk
+class DiscardingBuffer : public std::streambuf {
+protected:
+    std::streamsize xsputn(char const*, std::streamsize count) override {
+        return count;
+    }
+
+    int_type overflow(int_type character) override {
+        return traits_type::not_eof(character);
+    }
+};
+
+// a game's rolls, as pin counts
+struct RollSequence {
+    std::array<std::uint8_t, Game::MaxRolls> pins   = {};
+    size_t                                   count  = 0u;
+
+    constexpr std::span<const std::uint8_t> GetRolls() const {
+        return std::span(pins).first(count);
+    }
+};
+
+// builds a fixed set of random but valid games, seeded so every run plays the same ones
+static std::vector<RollSequence> MakeRandomGames(size_t gameCount) {
+    std::mt19937 rng(20240501u);
+    auto const rollUpTo = [&](unsigned maxPins) { return static_cast<std::uint8_t>(rng() % (maxPins + 1u)); };
+
+    std::vector<RollSequence> games(gameCount);
+    for (RollSequence& game : games) {
+        auto const add = [&](std::uint8_t pins) { game.pins[game.count++] = pins; };
+
+        for (unsigned frame = 0u; frame < Game::FinalFrame - 1u; frame++) {
+            std::uint8_t const first = rollUpTo(Game::NumPins);
+            add(first);
+            if (first < Game::NumPins) {
+                add(rollUpTo(Game::NumPins - first));
+            }
+        }
+
+        // the final frame earns its bonus rolls in place
+        std::uint8_t const first = rollUpTo(Game::NumPins);
+        add(first);
+        if (first == Game::NumPins) {
+            std::uint8_t const bonus = rollUpTo(Game::NumPins);
+            add(bonus);
+            add(rollUpTo(bonus == Game::NumPins ? Game::NumPins : Game::NumPins - bonus));
+        }
+        else {
+            std::uint8_t const second = rollUpTo(Game::NumPins - first);
+            add(second);
+            if (first + second == Game::NumPins) {
+                add(rollUpTo(Game::NumPins));
+            }
+        }
+    }
+
+    return games;
+}
+
+// plays a game roll by roll through TryRoll, returning its final score
+template <class PlayedGame>
+static unsigned PlayRolls(std::span<const std::uint8_t> rolls) {
+    PlayedGame game;
+    for (std::uint8_t const pins : rolls) {
+        KeepAlive(game.TryRoll(pins));
+    }
+
+    return game.GetScore();
+}
+
+// runs the whole-game benchmarks for one scoring engine
+template <class PlayedGame>
+static void RunGameBenchmarks(std::string_view engine, std::span<const RollSequence> randomGames) {
+    static constexpr std::array<std::uint8_t, 12u> PerfectGame = { 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10 };
+    static constexpr std::array<std::uint8_t, 20u> GutterGame = {};
+    static constexpr std::array<std::uint8_t, 21u> SpareGame = { 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5 };
+
+    RunBenchmark(std::format("{} perfect game", engine), 1u, [] { KeepAlive(PlayRolls<PlayedGame>(PerfectGame)); });
+    RunBenchmark(std::format("{} gutter game", engine), 1u, [] { KeepAlive(PlayRolls<PlayedGame>(GutterGame)); });
+    RunBenchmark(std::format("{} all-spare game", engine), 1u, [] { KeepAlive(PlayRolls<PlayedGame>(SpareGame)); });
+
+    size_t next = 0u;
+    RunBenchmark(std::format("{} random game", engine), 1u, [&] {
+        KeepAlive(PlayRolls<PlayedGame>(randomGames[next].GetRolls()));
+        next = (next + 1u) % randomGames.size();
+    });
+}
+
+// the command that starts the console app with no input and nowhere to print, so it exits at its first prompt
+static std::string MakeStartupCommand(std::string_view executable, std::string_view options) {
+#if defined(_WIN32)
+    // cmd strips the outermost quotes of a command, so the whole command is quoted once more
+    return std::format("\"\"{}\" {} < NUL > NUL\"", executable, options);
+#else
+    return std::format("\"{}\" {} < /dev/null > /dev/null", executable, options);
+#endif
+}
+
+// benchmarks take the console app's path as an optional argument, to time how long it takes to start up
+int main(int argc, char* argv[]) {
+    static constexpr size_t RandomGameCount = 4096u;
+    std::vector<RollSequence> const randomGames = MakeRandomGames(RandomGameCount);
+
+    std::cout << std::format("{:<36}{:>12}{:>14}{:>14}\n", "benchmark", "ns/op", "allocs/op", "bytes/op");
+
+    // per-roll latency, each iteration playing a full game of the same kind of roll
+    RunBenchmark("Roll", Game::MaxRolls - 1u, [] {
+        Game game;
+        for (unsigned i = 0u; i < Game::MaxRolls - 1u; i++) {
+            KeepAlive(game.Roll(4u));
+        }
+    });
+    RunBenchmark("Roll (rejected)", 1u, [] {
+        Game game;
+        KeepAlive(game.Roll(Game::NumPins + 1u));
+    });
+    RunBenchmark("RollSpare", Game::FinalFrame, [] {
+        Game game;
+        for (unsigned i = 0u; i < Game::FinalFrame; i++) {
+            KeepAlive(game.Roll(5u));
+            KeepAlive(game.RollSpare());
+        }
+    });
+    RunBenchmark("RollStrike", Game::FinalFrame + 2u, [] {
+        Game game;
+        for (unsigned i = 0u; i < Game::FinalFrame + 2u; i++) {
+            KeepAlive(game.RollStrike());
+        }
+    });
+
+    RunGameBenchmarks<Game>("Branching", randomGames);
+    RunGameBenchmarks<TableGame>("Table", randomGames);
+
+    size_t next = 0u;
+    RunBenchmark("FromRolls random game", 1u, [&] {
+        KeepAlive(Game::FromRolls(randomGames[next].GetRolls()));
+        next = (next + 1u) % randomGames.size();
+    });
+
+    // the exhaustive validator walking every way to play the final frame, per game it finishes
+    std::vector<std::uint8_t> const gutterFrames((Game::FinalFrame - 1u) * 2u, 0u);
+    size_t const finalFrameGames = GameValidator<Game>::Walk(gutterFrames).games;
+    RunBenchmark("GameValidator final frame", finalFrameGames, [&] { KeepAlive(GameValidator<Game>::Walk(gutterFrames)); });
+    RunBenchmark("GameValidator final frame (table)", finalFrameGames, [&] { KeepAlive(GameValidator<TableGame>::Walk(gutterFrames)); });
+
+    // queries and rendering, against games stopped at every point of play
+    std::vector<Game> partialGames(RandomGameCount);
+    for (size_t i = 0u; i < RandomGameCount; i++) {
+        std::span<const std::uint8_t> const rolls = randomGames[i].GetRolls();
+        for (std::uint8_t const pins : rolls.first(i % (rolls.size() + 1u))) {
+            partialGames[i].TryRoll(pins);
+        }
+    }
+
+    static constexpr size_t QueriesPerIteration = 64u;
+    next = 0u;
+    RunBenchmark("GetScore", QueriesPerIteration, [&] {
+        for (size_t i = 0u; i < QueriesPerIteration; i++) {
+            KeepAlive(partialGames[(next + i) % RandomGameCount].GetScore());
+        }
+        next = (next + QueriesPerIteration) % RandomGameCount;
+    });
+    RunBenchmark("GetMaxPossibleScore", QueriesPerIteration, [&] {
+        for (size_t i = 0u; i < QueriesPerIteration; i++) {
+            KeepAlive(partialGames[(next + i) % RandomGameCount].GetMaxPossibleScore());
+        }
+        next = (next + QueriesPerIteration) % RandomGameCount;
+    });
+    RunBenchmark("IsGameComplete", QueriesPerIteration, [&] {
+        for (size_t i = 0u; i < QueriesPerIteration; i++) {
+            KeepAlive(partialGames[(next + i) % RandomGameCount].IsGameComplete());
+        }
+        next = (next + QueriesPerIteration) % RandomGameCount;
+    });
+
+    // snapshots of a game that another thread keeps replaying the random games on
+    //-- afterwards a burst of snapshots is checked against replaying their own rolls, so a torn copy can't go unnoticed
+    size_t tornSnapshots = 0u;
+    {
+        static constexpr size_t CheckedSnapshots = 100000u;
+        Game sharedGame;
+        std::jthread writer([&](std::stop_token stop) {
+            for (size_t game = 0u; !stop.stop_requested(); game = (game + 1u) % RandomGameCount) {
+                sharedGame.Reset();
+                for (std::uint8_t const pins : randomGames[game].GetRolls()) {
+                    sharedGame.TryRoll(pins);
+                }
+            }
+        });
+        RunBenchmark("Snapshot under a concurrent writer", 1u, [&] { KeepAlive(sharedGame.Snapshot()); });
+
+        std::array<std::uint8_t, Game::MaxRolls> snapshotRolls;
+        for (size_t i = 0u; i < CheckedSnapshots; i++) {
+            Game const snapshot = sharedGame.Snapshot();
+            for (unsigned roll = 0u; roll < snapshot.GetRollCount(); roll++) {
+                snapshotRolls[roll] = static_cast<std::uint8_t>(snapshot.GetLoggedRoll(roll));
+            }
+            std::optional<Game> const replayed = Game::FromRolls(std::span(snapshotRolls).first(snapshot.GetRollCount()));
+            tornSnapshots += !replayed || *replayed != snapshot ? 1u : 0u;
+        }
+    }
+    if (tornSnapshots != 0u) {
+        std::cerr << std::format("{} snapshots were torn by the concurrent writer\n", tornSnapshots);
+        return 1;
+    }
+
+    // checkpoints of the same games, saved and restored
+    std::vector<Game::Checkpoint> checkpoints(RandomGameCount);
+    for (size_t i = 0u; i < RandomGameCount; i++) {
+        checkpoints[i] = partialGames[i].SaveCheckpoint();
+    }
+    RunBenchmark("SaveCheckpoint", QueriesPerIteration, [&] {
+        for (size_t i = 0u; i < QueriesPerIteration; i++) {
+            KeepAlive(partialGames[(next + i) % RandomGameCount].SaveCheckpoint());
+        }
+        next = (next + QueriesPerIteration) % RandomGameCount;
+    });
+    RunBenchmark("FromCheckpoint", QueriesPerIteration, [&] {
+        for (size_t i = 0u; i < QueriesPerIteration; i++) {
+            KeepAlive(Game::FromCheckpoint(checkpoints[(next + i) % RandomGameCount]));
+        }
+        next = (next + QueriesPerIteration) % RandomGameCount;
+    });
+
+    std::array<char, ScoreBoard::MaxLength> text;
+    RunBenchmark("ScoreBoard::Render", 1u, [&] {
+        KeepAlive(ScoreBoard::Render(partialGames[next], text));
+        KeepAlive(text);
+        next = (next + 1u) % RandomGameCount;
+    });
+
+    // a board following one game roll by roll, which is how the console app redraws it
+    ScoreBoard board;
+    RunBenchmark("ScoreBoard::Update whole game", 1u, [&] {
+        std::span<const std::uint8_t> const rolls = randomGames[next].GetRolls();
+        Game game;
+        for (std::uint8_t const pins : rolls) {
+            game.TryRoll(pins);
+            KeepAlive(board.Update(game));
+        }
+        next = (next + 1u) % RandomGameCount;
+    });
+    RunBenchmark("ScoreBoard::Update deltas whole game", 1u, [&] {
+        std::span<const std::uint8_t> const rolls = randomGames[next].GetRolls();
+        Game game;
+        KeepAlive(board.Update(game));
+        for (std::uint8_t const pins : rolls) {
+            KeepAlive(board.Update(game, game.TryRoll(pins).changedFrames));
+        }
+        next = (next + 1u) % RandomGameCount;
+    });
+
+    // a league of bowlers taking turns through the random games, then its standings read back in full
+    static constexpr size_t LeagueBowlers = 10000u;
+    std::vector<Game> completedGames(RandomGameCount);
+    for (size_t i = 0u; i < RandomGameCount; i++) {
+        completedGames[i] = Game::FromRolls(randomGames[i].GetRolls()).value();
+    }
+    SeasonStandings<> season(LeagueBowlers);
+    for (size_t i = 0u; i < LeagueBowlers; i++) {
+        season.AddBowler();
+    }
+    size_t nextBowler = 0u;
+    RunBenchmark("SeasonStandings::AddGame", 1u, [&] {
+        KeepAlive(season.AddGame(static_cast<SeasonStandings<>::BowlerId>(nextBowler), completedGames[next]));
+        nextBowler = (nextBowler + 1u) % LeagueBowlers;
+        next = (next + 1u) % RandomGameCount;
+    });
+    std::vector<Standing> standings(LeagueBowlers);
+    RunBenchmark("SeasonStandings::GetStandings per bowler", LeagueBowlers, [&] {
+        KeepAlive(season.GetStandings(standings));
+        KeepAlive(standings.front());
+    });
+    RunBenchmark("SeasonStandings re-rank per bowler", LeagueBowlers, [&] {
+        season.AddGame(static_cast<SeasonStandings<>::BowlerId>(nextBowler), completedGames[next]);
+        KeepAlive(season.GetStandings(standings));
+        KeepAlive(standings.front());
+        nextBowler = (nextBowler + 1u) % LeagueBowlers;
+        next = (next + 1u) % RandomGameCount;
+    });
+
+    // live win probabilities for a match at the fifth frame, with every bowler rolling like the random games
+    static constexpr size_t SimulatedRollouts = 10000u;
+    RollModel<> model;
+    for (RollSequence const& game : randomGames) {
+        model.ObserveGame(game.GetRolls());
+    }
+    std::array<RollSampler<>, 2u> const samplers = { RollSampler<>(model), RollSampler<>(model) };
+    std::array<Game, 2u> match;
+    for (size_t bowler = 0u; bowler < match.size(); bowler++) {
+        while (match[bowler].GetCurrentRoundIndex() < Game::FinalFrame / 2u) {
+            match[bowler].TryRoll(samplers[bowler].Sample(match[bowler].GetStandingPins(), static_cast<std::uint32_t>(bowler * 0x9e3779b9u + match[bowler].GetRollCount() * 0x7f4a7c15u)));
+        }
+    }
+    WorkStealingPool simulationPool;
+    OutcomeSimulator<> simulator(simulationPool);
+    std::uint64_t seed = 0u;
+    RunBenchmark("OutcomeSimulator::PlayOut", 1u, [&] {
+        SimulationRng rng = { seed++ };
+        KeepAlive(OutcomeSimulator<>::PlayOut(match[0], samplers[0], rng));
+    });
+    RunBenchmark("OutcomeSimulator 10k-rollout scores", 1u, [&] { KeepAlive(simulator.SimulateScores(match[0], samplers[0], SimulatedRollouts, seed++)); });
+    RunBenchmark("OutcomeSimulator 10k-rollout match", 1u, [&] { KeepAlive(simulator.SimulateMatch(match, samplers, SimulatedRollouts, seed++)); });
+
+    // a quarter of a million archived games, re-scored and then exported frame by frame to a columnar file
+    static constexpr size_t ArchivedGames = 256u * 1024u;
+    RollSequenceArchive archive;
+    for (size_t game = 0u; game < ArchivedGames; game++) {
+        archive.AddGame(randomGames[game % RandomGameCount].GetRolls());
+    }
+    std::vector<GameScore> archiveScores(ArchivedGames);
+    DiscardingBuffer discarded;
+    std::ostream exportStream(&discarded);
+    RunBenchmark("RescoreArchive per game", ArchivedGames, [&] {
+        RescoreArchive(archive, archiveScores, simulationPool);
+        KeepAlive(archiveScores.back());
+    });
+    RunBenchmark("ExportArchiveFrames per game", ArchivedGames, [&] { KeepAlive(ExportArchiveFrames(archive, exportStream, simulationPool)); });
+
+    // full batches of controller datagrams, each carrying the next roll of every lane, bowlers taking turns
+    //-- a lane starts over once all of its bowlers have finished, and the batches cycle round
+    using Service = ScoringService<>;
+    static constexpr size_t BatchCount = 16u;
+    auto const lanes = std::make_unique<Service::Lanes>();
+    auto const service = std::make_unique<Service>(*lanes);
+    std::vector<std::array<ScoringDatagram, Service::MaxBatchDatagrams>> batches(BatchCount);
+    std::array<size_t, Service::Lanes::Lanes> laneRolls{};
+    for (size_t lane = 0u; lane < Service::Lanes::Lanes; lane++) {
+        for (size_t bowler = 0u; bowler < Service::Lanes::MaxBowlers; bowler++) {
+            lanes->AddBowler(lane);
+        }
+    }
+    for (std::array<ScoringDatagram, Service::MaxBatchDatagrams>& batch : batches) {
+        for (ScoringDatagram& datagram : batch) {
+            ScoringHeader{ ScoringHeader::CurrentVersion, static_cast<std::uint8_t>(Service::Lanes::Lanes) }.Encode(datagram.bytes.data());
+            datagram.size = ScoringHeader::Size + Service::Lanes::Lanes * LaneCommand::Size;
+            for (size_t lane = 0u; lane < Service::Lanes::Lanes; lane++) {
+                size_t const turn = laneRolls[lane]++;
+                size_t const bowler = turn % Service::Lanes::MaxBowlers;
+                std::span<const std::uint8_t> const rolls = randomGames[(lane * Service::Lanes::MaxBowlers + bowler) % RandomGameCount].GetRolls();
+                size_t const roll = turn / Service::Lanes::MaxBowlers;
+
+                LaneCommand command = { LaneCommandKind::Roll, static_cast<std::uint8_t>(lane), static_cast<std::uint8_t>(bowler) };
+                if (roll < rolls.size()) {
+                    command.pinCount = rolls[roll];
+                }
+                else if (roll == Game::MaxRolls) {
+                    command.kind = LaneCommandKind::ResetLane;
+                    laneRolls[lane] = 0u;
+                }
+                command.Encode(datagram.bytes.data() + ScoringHeader::Size + lane * LaneCommand::Size);
+            }
+        }
+    }
+
+    size_t nextBatch = 0u;
+    std::array<ScoringDatagram, Service::MaxBatchDatagrams> replies;
+    RunBenchmark("ScoringService::Process per command", Service::MaxBatchDatagrams * Service::Lanes::Lanes, [&] {
+        KeepAlive(service->Process(batches[nextBatch], replies));
+        KeepAlive(replies);
+        nextBatch = (nextBatch + 1u) % BatchCount;
+    });
+
+    // the same batches from one center, with its lanes split over four cores that each score their own
+    //-- per command, this adds the splitting, the hand-off to the cores' threads and merging the replies back together
+    ShardRouter<Service> router(ShardMap(1u, 4u), 0u);
+    std::array<std::uint16_t, Service::MaxBatchDatagrams> batchCenters{};
+    router.AddCenter(0u, Service::Lanes::Lanes);
+    for (size_t lane = 0u; lane < Service::Lanes::Lanes; lane++) {
+        ScoringDatagram joins;
+        ScoringHeader{ ScoringHeader::CurrentVersion, static_cast<std::uint8_t>(Service::Lanes::MaxBowlers) }.Encode(joins.bytes.data());
+        joins.size = ScoringHeader::Size + Service::Lanes::MaxBowlers * LaneCommand::Size;
+        for (size_t bowler = 0u; bowler < Service::Lanes::MaxBowlers; bowler++) {
+            LaneCommand{ LaneCommandKind::AddBowler, static_cast<std::uint8_t>(lane) }.Encode(joins.bytes.data() + ScoringHeader::Size + bowler * LaneCommand::Size);
+        }
+        router.Process(std::span(batchCenters).first(1u), std::span(&joins, 1u), replies);
+    }
+    RunBenchmark("ShardRouter::Process per command", Service::MaxBatchDatagrams * Service::Lanes::Lanes, [&] {
+        KeepAlive(router.Process(batchCenters, batches[nextBatch], replies));
+        KeepAlive(replies);
+        nextBatch = (nextBatch + 1u) % BatchCount;
+    });
+
+    // a pinsetter thread posting a random game for every bowler on every lane, drained into the games on this thread
+    //-- while a reader thread keeps copying the lanes' snapshots, each checked against replaying its own rolls
+    //-- every iteration starts the games over, hands the pinsetter a new round and drains until it has all been applied
+    using Ingestor = RollIngestor<>;
+    auto const ingestLanes = std::make_unique<Ingestor::Lanes>();
+    Ingestor ingestor(*ingestLanes);
+    size_t ingestRolls = 0u;
+    for (size_t lane = 0u; lane < Ingestor::Lanes::Lanes; lane++) {
+        for (size_t bowler = 0u; bowler < Ingestor::Lanes::MaxBowlers; bowler++) {
+            ingestLanes->AddBowler(lane);
+            ingestRolls += randomGames[(lane * Ingestor::Lanes::MaxBowlers + bowler) % RandomGameCount].count;
+        }
+        ingestor.Publish(lane);
+    }
+
+    std::atomic<std::uint32_t> ingestRound = 0u;
+    std::atomic<size_t> tornLanes = 0u;
+    {
+        std::jthread pinsetter([&](std::stop_token stop) {
+            for (std::uint32_t round = 0u; true; round++) {
+                ingestRound.wait(round, std::memory_order_acquire);
+                if (stop.stop_requested()) {
+                    return;
+                }
+
+                for (size_t roll = 0u; roll < Game::MaxRolls; roll++) {
+                    for (size_t lane = 0u; lane < Ingestor::Lanes::Lanes; lane++) {
+                        for (size_t bowler = 0u; bowler < Ingestor::Lanes::MaxBowlers; bowler++) {
+                            RollSequence const& game = randomGames[(lane * Ingestor::Lanes::MaxBowlers + bowler) % RandomGameCount];
+                            if (roll < game.count) {
+                                while (!ingestor.Post(lane, { static_cast<std::uint8_t>(bowler), game.pins[roll] })) {
+                                    std::this_thread::yield();
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        });
+        std::jthread reader([&](std::stop_token stop) {
+            std::array<std::uint8_t, Game::MaxRolls> rolls;
+            while (!stop.stop_requested()) {
+                for (size_t lane = 0u; lane < Ingestor::Lanes::Lanes; lane++) {
+                    Ingestor::LaneSnapshot const snapshot = ingestor.ReadSnapshot(lane);
+                    bool isTorn = snapshot.bowlerCount != Ingestor::Lanes::MaxBowlers;
+                    for (Game const& game : std::span(snapshot.games).first(snapshot.bowlerCount)) {
+                        for (unsigned roll = 0u; roll < game.GetRollCount(); roll++) {
+                            rolls[roll] = static_cast<std::uint8_t>(game.GetLoggedRoll(roll));
+                        }
+                        std::optional<Game> const replayed = Game::FromRolls(std::span(rolls).first(game.GetRollCount()));
+                        isTorn = isTorn || !replayed || *replayed != game;
+                    }
+                    tornLanes.fetch_add(isTorn ? 1u : 0u, std::memory_order_relaxed);
+                }
+            }
+        });
+
+        RunBenchmark("RollIngestor post to drain per roll", ingestRolls, [&] {
+            for (size_t lane = 0u; lane < Ingestor::Lanes::Lanes; lane++) {
+                for (size_t bowler = 0u; bowler < Ingestor::Lanes::MaxBowlers; bowler++) {
+                    ingestLanes->GetGame(lane, bowler)->Reset();
+                }
+            }
+            ingestRound.fetch_add(1u, std::memory_order_release);
+            ingestRound.notify_one();
+
+            for (size_t applied = 0u; applied < ingestRolls;) {
+                size_t drained = 0u;
+                for (size_t lane = 0u; lane < Ingestor::Lanes::Lanes; lane++) {
+                    drained += ingestor.Drain(lane);
+                }
+                if (drained == 0u) {
+                    std::this_thread::yield();
+                }
+                applied += drained;
+            }
+        });
+
+        pinsetter.request_stop();
+        ingestRound.fetch_add(1u, std::memory_order_release);
+        ingestRound.notify_one();
+    }
+    if (size_t const torn = tornLanes.load(std::memory_order_relaxed); torn != 0u) {
+        std::cerr << std::format("{} lane snapshots were torn while ingesting\n", torn);
+        return 1;
+    }
+
+    // journaling a roll from every lane and committing them with one sync, against syncing each roll on its own
+    //-- the journal goes to the working directory, so these measure whatever disk that's on
+    static constexpr char const* JournalPath = "bench-journal.ebrj";
+    std::array<RollJournal::Entry, Service::Lanes::Lanes> laneEntries{};
+    for (size_t lane = 0u; lane < laneEntries.size(); lane++) {
+        laneEntries[lane] = { GameHandle{ static_cast<std::uint32_t>(lane), 0u }, static_cast<std::uint16_t>(lane), 5u };
+    }
+    std::remove(JournalPath);
+    if (RollJournal journal; journal.Open(JournalPath)) {
+        RunBenchmark("RollJournal group commit per roll", laneEntries.size(), [&] { KeepAlive(journal.Commit(journal.Append(laneEntries))); });
+        RunBenchmark("RollJournal commit every roll", 1u, [&] { KeepAlive(journal.Commit(journal.Append(std::span(laneEntries).first(1u)))); });
+    }
+    std::remove(JournalPath);
+
+    // from launching the console app to its first prompt, process start-up and shutdown included
+    if (argc >= 2) {
+        std::string const withExample = MakeStartupCommand(argv[1], "");
+        std::string const withoutExample = MakeStartupCommand(argv[1], "--no-example");
+        RunBenchmark("Startup to first prompt", 1u, [&] { KeepAlive(std::system(withExample.c_str())); });
+        RunBenchmark("Startup to first prompt (--no-example)", 1u, [&] { KeepAlive(std::system(withoutExample.c_str())); });
+    }
+
+    return 0;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+// the SSE 4.2 crc32 instruction computes this very checksum, 8 bytes at a time
+#if (defined(__SSE4_2__) || defined(_MSC_VER) && defined(__AVX__)) && (defined(__x86_64__) || defined(_M_X64))
+#include <nmmintrin.h>
+#define EXPERIS_HAS_CRC32C_INSTRUCTIONS
+#endif
+
+namespace ExperisBowling {
+    // Running CRC-32C (Castagnoli) checksum, table-driven so it also works in constant expressions.
+    //-- values are fed in little-endian byte order, so a checksum means the same on every host
+    //-- builds targeting SSE 4.2 feed whole values to the crc32 instruction instead, outside constant expressions
+    class Crc32c {
+    private:
+        static constexpr std::uint32_t Polynomial = 0x82f63b78u; // reflected
+
+        // the running checksum's change for every possible low byte, then for that byte followed by one, two and three zero bytes
+        //-- the four together fold a whole 32-bit word into the checksum with four independent lookups
+        static constexpr std::array<std::array<std::uint32_t, 256u>, 4u> Tables = [] {
+            std::array<std::array<std::uint32_t, 256u>, 4u> tables{};
+            for (std::uint32_t i = 0u; i < 256u; i++) {
+                std::uint32_t crc = i;
+                for (unsigned bit = 0u; bit < 8u; bit++) {
+                    crc = (crc >> 1u) ^ ((crc & 1u) != 0u ? Polynomial : 0u);
+                }
+                tables[0][i] = crc;
+            }
+            for (size_t slice = 1u; slice < tables.size(); slice++) {
+                for (size_t i = 0u; i < 256u; i++) {
+                    tables[slice][i] = (tables[slice - 1u][i] >> 8u) ^ tables[0][tables[slice - 1u][i] & 0xffu];
+                }
+            }
+
+            return tables;
+        }();
+
+        std::uint32_t   crc     = ~0u;
+
+    public:
+        constexpr Crc32c& Update(std::span<const std::uint8_t> bytes) {
+            size_t i = 0u;
+            for (; i + 4u <= bytes.size(); i += 4u) {
+                UpdateWord(std::uint32_t{ bytes[i] } | std::uint32_t{ bytes[i + 1u] } << 8u | std::uint32_t{ bytes[i + 2u] } << 16u | std::uint32_t{ bytes[i + 3u] } << 24u);
+            }
+            for (; i < bytes.size(); i++) {
+                UpdateByte(bytes[i]);
+            }
+
+            return *this;
+        }
+
+        template <class T>
+            requires std::is_unsigned_v<T>
+        constexpr Crc32c& Update(T value) {
+#if defined(EXPERIS_HAS_CRC32C_INSTRUCTIONS)
+            if (!std::is_constant_evaluated()) {
+                if constexpr (sizeof(T) == 8u) {
+                    crc = static_cast<std::uint32_t>(_mm_crc32_u64(crc, value));
+                }
+                else if constexpr (sizeof(T) == 4u) {
+                    crc = _mm_crc32_u32(crc, value);
+                }
+                else if constexpr (sizeof(T) == 2u) {
+                    crc = _mm_crc32_u16(crc, value);
+                }
+                else {
+                    crc = _mm_crc32_u8(crc, value);
+                }
+
+                return *this;
+            }
+#endif
+            if constexpr (sizeof(T) >= 4u) {
+                for (size_t word = 0u; word < sizeof(T); word += 4u) {
+                    UpdateWord(static_cast<std::uint32_t>(value >> (8u * word)));
+                }
+            }
+            else {
+                for (size_t i = 0u; i < sizeof(T); i++) {
+                    UpdateByte(static_cast<std::uint8_t>(value >> (8u * i)));
+                }
+            }
+
+            return *this;
+        }
+
+        constexpr std::uint32_t Get() const {
+            return ~crc;
+        }
+
+    private:
+        constexpr void UpdateByte(std::uint8_t byte) {
+            crc = (crc >> 8u) ^ Tables[0][(crc ^ byte) & 0xffu];
+        }
+
+        // folds in four bytes at once, the first of them in the low bits
+        constexpr void UpdateWord(std::uint32_t word) {
+            std::uint32_t const bits = crc ^ word;
+            crc = Tables[3][bits & 0xffu] ^ Tables[2][(bits >> 8u) & 0xffu] ^ Tables[1][(bits >> 16u) & 0xffu] ^ Tables[0][bits >> 24u];
+        }
+    };
+} // namespace ExperisBowling
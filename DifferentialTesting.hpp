@@ -0,0 +1,399 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include "BatchScorer.hpp"
+#include <cstdint>
+#include "Game.hpp"
+#include "GameValidation.hpp"
+#include "OutcomeSimulator.hpp"
+#include "ScoringTables.hpp"
+#include <span>
+#include <string_view>
+#include <vector>
+#include "WorkStealingPool.hpp"
+
+namespace ExperisBowling {
+    // the checks a roll sequence is put through, in the order they run
+    enum class DifferentialCheck : std::uint8_t {
+        None,
+        AcceptedRolls,      // Game::TryRoll() stopped at a different roll than the reference
+        Completion,         // the game and the reference disagree on whether it's over
+        StandingPins,
+        Score,
+        ScoreBounds,        // the min and max possible scores aren't what gutters and strikes to the end actually score
+        TableScoring,       // the table engine played the rolls differently
+        ScoreRolls,         // scoring the sequence in one pass differs from rolling it ball by ball
+        UndoRedo,
+        Checkpoint,
+        BatchScoring,       // the SIMD batch kernel differs from the scalar game
+    };
+
+    constexpr std::string_view GetCheckName(DifferentialCheck check) {
+        switch (check) {
+        case DifferentialCheck::None:           return "none";
+        case DifferentialCheck::AcceptedRolls:  return "accepted rolls";
+        case DifferentialCheck::Completion:     return "completion";
+        case DifferentialCheck::StandingPins:   return "standing pins";
+        case DifferentialCheck::Score:          return "score";
+        case DifferentialCheck::ScoreBounds:    return "score bounds";
+        case DifferentialCheck::TableScoring:   return "table scoring";
+        case DifferentialCheck::ScoreRolls:     return "one-pass scoring";
+        case DifferentialCheck::UndoRedo:       return "undo and redo";
+        case DifferentialCheck::Checkpoint:     return "checkpoint";
+        case DifferentialCheck::BatchScoring:   return "batch scoring";
+        }
+
+        return "unknown";
+    }
+
+    // a roll sequence under test, long enough to run a few rolls past the end of any game
+    struct FuzzRolls {
+        static constexpr size_t Capacity = Game::MaxRolls + 3u;
+
+        std::array<std::uint8_t, Capacity>  pins    = {};
+        std::uint8_t                        count   = 0u;
+
+        constexpr std::span<const std::uint8_t> GetRolls() const {
+            return std::span(pins).first(count);
+        }
+
+        constexpr void Add(unsigned pinCount) {
+            if (count < Capacity) {
+                pins[count++] = static_cast<std::uint8_t>(pinCount);
+            }
+        }
+    };
+
+    // whether two games, on any engines, hold the same state of play and the same rolls in their logs
+    template <class PlayedGame, class OtherGame>
+    constexpr bool IsSamePlay(PlayedGame const& game, OtherGame const& other) {
+        if (game.GetCurrentRoundIndex() != other.GetCurrentRoundIndex() || game.GetScore() != other.GetScore()
+            || game.GetProvisionalScore() != other.GetProvisionalScore() || game.GetRollCount() != other.GetRollCount()) {
+            return false;
+        }
+
+        for (size_t i = 0u; i < PlayedGame::MaxFrames; i++) {
+            if (game.GetFrame(i) != other.GetFrame(i)) {
+                return false;
+            }
+        }
+        for (unsigned i = 0u; i < game.GetRollCount(); i++) {
+            if (game.GetLoggedRoll(i) != other.GetLoggedRoll(i)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // Plays a roll sequence through every scalar engine and cross-checks them, returning the first check that fails.
+    //-- ReferenceScorer is the oracle for which rolls are legal and what a finished game scores; the engines then
+    //-- have to agree with each other on everything else, down to the state the checkpoint and roll log keep
+    constexpr DifferentialCheck CheckRollSequence(std::span<const std::uint8_t> rolls) {
+        using Reference = ReferenceScorer<>;
+
+        Game game{};
+        TableGame tableGame{};
+        size_t accepted = 0u;
+        RollError rejection = RollError::None;
+        for (; accepted < rolls.size(); accepted++) {
+            RollResult const result = game.TryRoll(rolls[accepted]);
+            RollResult const tableResult = tableGame.TryRoll(rolls[accepted]);
+            if (result.error != tableResult.error) {
+                return DifferentialCheck::TableScoring;
+            }
+            if (!result) {
+                rejection = result.error;
+                break;
+            }
+        }
+
+        // the engine has to take every roll the reference calls legal, and stop at the first one it doesn't
+        std::span<const std::uint8_t> const played = rolls.first(accepted);
+        Reference::Result const expected = Reference::Evaluate(played);
+        if (!expected.isValid || (accepted < rolls.size() && Reference::Evaluate(rolls.first(accepted + 1u)).isValid)) {
+            return DifferentialCheck::AcceptedRolls;
+        }
+        if (game.IsGameComplete() != expected.isComplete || (rejection == RollError::GameComplete) != (accepted < rolls.size() && expected.isComplete)) {
+            return DifferentialCheck::Completion;
+        }
+        if (game.GetStandingPins() != expected.standingPins) {
+            return DifferentialCheck::StandingPins;
+        }
+        if (game.GetRollCount() != accepted || (expected.isComplete && (game.GetScore() != expected.score || game.GetProvisionalScore() != expected.score))) {
+            return DifferentialCheck::Score;
+        }
+
+        // gutters to the end reach the lowest score the game can still finish on, strikes to the end the highest
+        Game gutters = game;
+        Game strikes = game;
+        while (!gutters.IsGameComplete() && gutters.TryRoll(0u)) {
+        }
+        while (!strikes.IsGameComplete() && strikes.TryRoll(strikes.GetStandingPins())) {
+        }
+        if (game.GetMinPossibleScore() != gutters.GetScore() || game.GetMaxPossibleScore() != strikes.GetScore()) {
+            return DifferentialCheck::ScoreBounds;
+        }
+
+        if (!IsSamePlay(tableGame, game)) {
+            return DifferentialCheck::TableScoring;
+        }
+
+        // one-pass scoring keeps the rolls before the first one it turns away, the same ones rolling ball by ball took
+        Game scored{};
+        TableGame tableScored{};
+        bool const isScored = static_cast<bool>(scored.ScoreRolls(rolls));
+        if (isScored != (accepted == rolls.size()) || !IsSamePlay(scored, game)
+            || static_cast<bool>(tableScored.ScoreRolls(rolls)) != isScored || !IsSamePlay(tableScored, game)) {
+            return DifferentialCheck::ScoreRolls;
+        }
+
+        Game undone = game;
+        size_t undoneRolls = 0u;
+        while (undone.Undo()) {
+            undoneRolls++;
+        }
+        bool const isUndone = undoneRolls == accepted && undone == Game{};
+        while (undone.Redo()) {
+        }
+        if (!isUndone || !IsSamePlay(undone, game)) {
+            return DifferentialCheck::UndoRedo;
+        }
+
+        std::optional<Game> const restored = Game::FromCheckpoint(game.SaveCheckpoint());
+        if (!restored || !IsSamePlay(*restored, game)) {
+            return DifferentialCheck::Checkpoint;
+        }
+
+        return DifferentialCheck::None;
+    }
+
+    // Checks a group of sequences against the batch kernel at once, one sequence per lane.
+    //-- the kernel only scores complete games, so every lane has to be valid exactly when its rolls make one
+    constexpr void CheckBatchScoring(std::span<const FuzzRolls> sequences, std::span<DifferentialCheck> results) {
+        using Scorer = BatchScorer<>;
+
+        Scorer::Rolls rolls;
+        Scorer::Scores scores;
+        size_t const laneCount = std::min(sequences.size(), Scorer::Lanes);
+        for (size_t lane = 0u; lane < Scorer::Lanes; lane++) {
+            rolls.SetGame(lane, lane < laneCount ? sequences[lane].GetRolls() : std::span<const std::uint8_t>{});
+        }
+
+        Scorer::Score(rolls, scores);
+
+        for (size_t lane = 0u; lane < laneCount; lane++) {
+            if (results[lane] == DifferentialCheck::None && !Scorer::MatchesGame(scores, lane, sequences[lane].GetRolls())) {
+                results[lane] = DifferentialCheck::BatchScoring;
+            }
+        }
+    }
+
+    // every check on a single sequence, the batch kernel included
+    constexpr DifferentialCheck CheckEveryEngine(FuzzRolls const& rolls) {
+        std::array<DifferentialCheck, 1u> result = { CheckRollSequence(rolls.GetRolls()) };
+        CheckBatchScoring(std::span(&rolls, 1u), result);
+
+        return result[0];
+    }
+
+    // Generates roll sequences aimed at the edge cases: runs of strikes and spares into the bonus frames, gutters,
+    //-- pin counts one past what's standing, games cut short, and rolls after a game is over.
+    //-- a shadow game only steers the generator towards those cases, the checks never take its word for anything
+    class RollSequenceFuzzer {
+    private:
+        // how the next roll relates to the pins left standing
+        enum class RollKind : std::uint8_t {
+            ClearRack,  // a strike or a spare
+            Gutter,
+            Legal,      // anything from a gutter up to clearing the rack
+            Raw,        // any pin count up to 63, usually impossible
+        };
+
+        SimulationRng   rng;
+
+    public:
+        constexpr explicit RollSequenceFuzzer(std::uint64_t seed)
+            : rng{ seed } {
+        }
+
+        // a random sequence, mostly legal so it reaches the final frames, with a few illegal or extra rolls
+        constexpr FuzzRolls Next() {
+            Game shadow{};
+            FuzzRolls rolls;
+            std::uint64_t const shape = rng.Next();
+            size_t const cutOff = shape % 8u == 0u ? static_cast<size_t>(shape >> 8u) % FuzzRolls::Capacity : FuzzRolls::Capacity;
+            size_t const extraRolls = shape % 8u == 1u ? 1u + static_cast<size_t>(shape >> 16u) % 2u : 0u;
+            unsigned const illegalOdds = shape % 4u == 2u ? 16u : 256u;
+
+            while (rolls.count < cutOff && (!shadow.IsGameComplete() || rolls.count < shadow.GetRollCount() + extraRolls)) {
+                std::uint64_t const choice = rng.Next();
+                unsigned const weight = static_cast<unsigned>(choice % illegalOdds);
+                RollKind const kind = weight == 0u ? RollKind::Raw : weight % 8u < 3u ? RollKind::ClearRack : weight % 8u < 4u ? RollKind::Gutter : RollKind::Legal;
+                unsigned const pinCount = PickPins(kind, static_cast<unsigned>(choice >> 32u), shadow.GetStandingPins());
+                rolls.Add(pinCount);
+                shadow.TryRoll(pinCount);
+            }
+
+            return rolls;
+        }
+
+        // turns arbitrary bytes into a sequence for a coverage-guided fuzzer, one roll per byte
+        //-- the top two bits of a byte pick how the roll relates to the standing pins and the rest pick within that,
+        //-- so mutating a byte keeps the roll's meaning mostly intact instead of turning it into noise
+        static constexpr FuzzRolls Decode(std::span<const std::uint8_t> bytes) {
+            Game shadow{};
+            FuzzRolls rolls;
+            for (std::uint8_t const byte : bytes.first(std::min(bytes.size(), FuzzRolls::Capacity))) {
+                unsigned const pinCount = PickPins(static_cast<RollKind>(byte >> 6u), byte & 0x3fu, shadow.GetStandingPins());
+                rolls.Add(pinCount);
+                shadow.TryRoll(pinCount);
+            }
+
+            return rolls;
+        }
+
+    private:
+        static constexpr unsigned PickPins(RollKind kind, unsigned value, unsigned standingPins) {
+            switch (kind) {
+            case RollKind::ClearRack:
+                return standingPins > 0u ? standingPins : Game::NumPins;
+            case RollKind::Gutter:
+                return 0u;
+            case RollKind::Legal:
+                return value % (standingPins + 1u);
+            case RollKind::Raw:
+                return value & 0x3fu;
+            }
+
+            return 0u;
+        }
+    };
+
+    // Shrinks a sequence that fails a check to a smaller one failing the same check.
+    //-- drops single rolls, latest first, then lowers single rolls, until neither gets any further
+    template <class Check = DifferentialCheck (*)(FuzzRolls const&)>
+    constexpr FuzzRolls MinimizeFailure(FuzzRolls rolls, DifferentialCheck failure, Check&& check = CheckEveryEngine) {
+        for (bool isShrinking = true; isShrinking;) {
+            isShrinking = false;
+            for (size_t i = rolls.count; i-- > 0u;) {
+                FuzzRolls shorter = rolls;
+                std::copy(rolls.pins.begin() + i + 1u, rolls.pins.begin() + rolls.count, shorter.pins.begin() + i);
+                shorter.count--;
+                if (check(shorter) == failure) {
+                    rolls = shorter;
+                    isShrinking = true;
+                }
+            }
+
+            for (size_t i = 0u; i < rolls.count; i++) {
+                for (unsigned const lower : { 0u, rolls.pins[i] / 2u, rolls.pins[i] - 1u }) {
+                    FuzzRolls lowered = rolls;
+                    lowered.pins[i] = static_cast<std::uint8_t>(lower);
+                    if (lower < rolls.pins[i] && check(lowered) == failure) {
+                        rolls = lowered;
+                        isShrinking = true;
+                        break;
+                    }
+                }
+            }
+        }
+
+        return rolls;
+    }
+
+    // a sequence the engines disagreed on
+    struct Divergence {
+        DifferentialCheck   check       = DifferentialCheck::None;
+        std::uint64_t       sequence    = 0u;   // its index in the run, which the run's seed regenerates it from
+        FuzzRolls           rolls;
+        FuzzRolls           minimized;
+    };
+
+    // what a differential run found
+    struct DifferentialReport {
+        static constexpr size_t MaxDivergences = 8u;   // repros kept, the earliest in the run
+
+        std::uint64_t                               sequences   = 0u;
+        std::uint64_t                               rolls       = 0u;
+        std::uint64_t                               divergences = 0u;   // every one found, kept or not
+        std::array<Divergence, MaxDivergences>      found       = {};
+
+        constexpr std::span<const Divergence> GetDivergences() const {
+            return std::span(found).first(static_cast<size_t>(std::min<std::uint64_t>(divergences, MaxDivergences)));
+        }
+    };
+
+    // Runs random sequences through every engine across the pool, minimizing the first divergences it finds.
+    //-- sequences are generated in fixed blocks, each from its own generator seeded by the run's seed and the block,
+    //-- so a run finds the same divergences however many threads it has
+    class DifferentialTester {
+    public:
+        static constexpr size_t SequencesPerBlock = 64u * BatchScorer<>::Lanes;
+
+    private:
+        WorkStealingPool&                   pool;
+        std::vector<DifferentialReport>     blockReports;   // kept between runs, so a run only allocates the first time it's this big
+
+    public:
+        explicit DifferentialTester(WorkStealingPool& workerPool)
+            : pool(workerPool) {
+        }
+
+        DifferentialReport Run(std::uint64_t sequences, std::uint64_t seed) {
+            size_t const blockCount = static_cast<size_t>((sequences + SequencesPerBlock - 1u) / SequencesPerBlock);
+            blockReports.resize(std::max(blockReports.size(), blockCount));
+
+            pool.ParallelFor(blockCount, [&](size_t block) {
+                DifferentialReport& report = blockReports[block];
+                report = {};
+
+                RollSequenceFuzzer fuzzer(MakeSeed(seed, block));
+                std::array<FuzzRolls, BatchScorer<>::Lanes> group;
+                std::array<DifferentialCheck, BatchScorer<>::Lanes> results;
+                std::uint64_t const first = block * std::uint64_t{ SequencesPerBlock };
+                std::uint64_t const end = std::min<std::uint64_t>(sequences, first + SequencesPerBlock);
+                for (std::uint64_t groupStart = first; groupStart < end; groupStart += group.size()) {
+                    size_t const groupSize = static_cast<size_t>(std::min<std::uint64_t>(group.size(), end - groupStart));
+                    for (size_t i = 0u; i < groupSize; i++) {
+                        group[i] = fuzzer.Next();
+                        results[i] = CheckRollSequence(group[i].GetRolls());
+                        report.rolls += group[i].count;
+                    }
+                    CheckBatchScoring(std::span(group).first(groupSize), results);
+
+                    for (size_t i = 0u; i < groupSize; i++) {
+                        if (results[i] != DifferentialCheck::None && report.divergences++ < DifferentialReport::MaxDivergences) {
+                            report.found[report.divergences - 1u] = { results[i], groupStart + i, group[i], group[i] };
+                        }
+                    }
+                    report.sequences += groupSize;
+                }
+            });
+
+            DifferentialReport total;
+            for (size_t block = 0u; block < blockCount; block++) {
+                DifferentialReport const& report = blockReports[block];
+                for (Divergence const& divergence : report.GetDivergences()) {
+                    if (total.divergences < DifferentialReport::MaxDivergences) {
+                        total.found[total.divergences] = divergence;
+                        total.found[total.divergences].minimized = MinimizeFailure(divergence.rolls, divergence.check);
+                    }
+                    total.divergences++;
+                }
+                total.divergences += report.divergences - report.GetDivergences().size();
+                total.sequences += report.sequences;
+                total.rolls += report.rolls;
+            }
+
+            return total;
+        }
+
+    private:
+        static constexpr std::uint64_t MakeSeed(std::uint64_t seed, size_t block) {
+            SimulationRng mixer = { seed ^ (static_cast<std::uint64_t>(block) * 0xd1b54a32d192ed03u) };
+            return mixer.Next();
+        }
+    };
+} // namespace ExperisBowling
@@ -0,0 +1,529 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include "Archive.hpp"
+#include "BatchScorer.hpp"
+#include "Crc32.hpp"
+#include <cstdint>
+#include "Game.hpp"
+#include "GamePool.hpp"
+#include <optional>
+#include <ostream>
+#include "Rescore.hpp"
+#include <span>
+#include <string_view>
+#include <vector>
+#include "WorkStealingPool.hpp"
+
+namespace ExperisBowling {
+    // how a column's values are stored
+    enum class ColumnType : std::uint8_t {
+        Bool    = 1u,   // one bit per row
+        UInt8   = 2u,
+        UInt16  = 3u,
+        UInt32  = 4u,
+    };
+
+    struct ExportColumn {
+        std::string_view    name;
+        ColumnType          type        = ColumnType::UInt8;
+        bool                isNullable  = false;    // rows without a value are cleared in the column's validity bitmap
+    };
+
+    // the columns of a frame export, one row per regular frame of every completed game
+    //-- the final frame's bonus rolls get columns of their own, so a strike's missing second roll stays missing
+    enum class FrameColumn : std::uint8_t {
+        Game,                   // the game's index in the archive or its slot in the pool
+        Frame,
+        PinsOnFirstRoll,
+        PinsOnSecondRoll,
+        PinsOnFirstBonusRoll,
+        PinsOnSecondBonusRoll,
+        IsStrike,
+        IsSpare,
+        CurrentScore,
+        TotalScore,
+    };
+
+    inline constexpr std::array<ExportColumn, 10u> FrameColumns = { {
+        { "game", ColumnType::UInt32 },
+        { "frame", ColumnType::UInt8 },
+        { "pinsOnFirstRoll", ColumnType::UInt8 },
+        { "pinsOnSecondRoll", ColumnType::UInt8, true },
+        { "pinsOnFirstBonusRoll", ColumnType::UInt8, true },
+        { "pinsOnSecondBonusRoll", ColumnType::UInt8, true },
+        { "isStrike", ColumnType::Bool },
+        { "isSpare", ColumnType::Bool },
+        { "currentScore", ColumnType::UInt8 },
+        { "totalScore", ColumnType::UInt16 },
+    } };
+
+    // Layout of a frame export, little-endian throughout, laid out like an Arrow stream without the flatbuffers:
+    //   header  - magic, version, column count, then each column's type, flags, name length and name, padded to 8 bytes
+    //   batches - FrameExportFormat::BatchHeaderSize bytes of row count, body size and the body's CRC-32C, then the body
+    //   end     - a batch header with no rows
+    // a batch body holds every column in header order, each as an optional validity bitmap and then its values, every
+    // buffer padded to 8 bytes; bitmaps number rows from the lowest bit of their first byte, and a set bit means present
+    struct FrameExportFormat {
+        static constexpr std::array<std::uint8_t, 4u>   Magic           = { 'E', 'B', 'F', 'X' };
+        static constexpr std::uint8_t                   CurrentVersion  = 1u;
+        static constexpr size_t                         Alignment       = 8u;
+        static constexpr size_t                         BatchHeaderSize = 16u;
+        static constexpr std::uint8_t                   NullableFlag    = 1u;
+
+        // byte offsets in the header and in each batch header
+        static constexpr size_t VersionOffset = 4u;
+        static constexpr size_t ColumnCountOffset = 5u;
+        static constexpr size_t ColumnsOffset = 8u;
+        static constexpr size_t RowCountOffset = 0u;
+        static constexpr size_t BodySizeOffset = 4u;
+        static constexpr size_t ChecksumOffset = 8u;
+
+        // where a column's buffers start in a batch body
+        struct ColumnBuffers {
+            size_t  validityOffset  = 0u;
+            size_t  valuesOffset    = 0u;
+        };
+
+        struct BatchLayout {
+            std::array<ColumnBuffers, FrameColumns.size()>  columns     = {};
+            size_t                                          bodySize    = 0u;
+        };
+
+        template <class T>
+        static constexpr T LoadLittleEndian(std::uint8_t const* bytes) {
+            T value = 0u;
+            for (size_t i = 0u; i < sizeof(T); i++) {
+                value |= static_cast<T>(static_cast<T>(bytes[i]) << (8u * i));
+            }
+
+            return value;
+        }
+
+        template <class T>
+        static constexpr void StoreLittleEndian(std::uint8_t* bytes, T value) {
+            for (size_t i = 0u; i < sizeof(T); i++) {
+                bytes[i] = static_cast<std::uint8_t>(value >> (8u * i));
+            }
+        }
+
+        static constexpr size_t Pad(size_t size) {
+            return (size + Alignment - 1u) / Alignment * Alignment;
+        }
+
+        static constexpr size_t GetValueSize(ColumnType type, size_t rowCount) {
+            switch (type) {
+            case ColumnType::Bool:      return (rowCount + 7u) / 8u;
+            case ColumnType::UInt8:     return rowCount;
+            case ColumnType::UInt16:    return rowCount * 2u;
+            case ColumnType::UInt32:    return rowCount * 4u;
+            }
+
+            return 0u;
+        }
+
+        static constexpr BatchLayout GetBatchLayout(size_t rowCount) {
+            BatchLayout layout;
+            for (size_t column = 0u; column < FrameColumns.size(); column++) {
+                layout.columns[column].validityOffset = layout.bodySize;
+                layout.bodySize += FrameColumns[column].isNullable ? Pad((rowCount + 7u) / 8u) : 0u;
+                layout.columns[column].valuesOffset = layout.bodySize;
+                layout.bodySize += Pad(GetValueSize(FrameColumns[column].type, rowCount));
+            }
+
+            return layout;
+        }
+
+        static constexpr size_t GetHeaderSize() {
+            size_t size = ColumnsOffset;
+            for (ExportColumn const& column : FrameColumns) {
+                size += 3u + column.name.size();
+            }
+
+            return Pad(size);
+        }
+
+        static constexpr void EncodeHeader(std::vector<std::uint8_t>& bytes) {
+            bytes.assign(GetHeaderSize(), 0u);
+            std::copy(Magic.begin(), Magic.end(), bytes.begin());
+            bytes[VersionOffset] = CurrentVersion;
+            bytes[ColumnCountOffset] = static_cast<std::uint8_t>(FrameColumns.size());
+
+            size_t offset = ColumnsOffset;
+            for (ExportColumn const& column : FrameColumns) {
+                bytes[offset++] = static_cast<std::uint8_t>(column.type);
+                bytes[offset++] = column.isNullable ? NullableFlag : 0u;
+                bytes[offset++] = static_cast<std::uint8_t>(column.name.size());
+                offset = static_cast<size_t>(std::copy(column.name.begin(), column.name.end(), bytes.begin() + static_cast<std::ptrdiff_t>(offset)) - bytes.begin());
+            }
+        }
+
+        // checks that a file starts with the header this build writes, returning where its first batch starts
+        static constexpr std::optional<size_t> DecodeHeader(std::span<const std::uint8_t> bytes) {
+            std::vector<std::uint8_t> expected;
+            EncodeHeader(expected);
+            if (bytes.size() < expected.size() || !std::equal(expected.begin(), expected.end(), bytes.begin())) {
+                return std::nullopt;
+            }
+
+            return expected.size();
+        }
+    };
+
+    // One batch of frame rows, held column by column in the layout the export writes them in.
+    //-- its buffers are sized for the most rows it takes up front and reused from batch to batch, so an export only
+    //-- ever holds as many rows as its batches can
+    class FrameBatch {
+    public:
+        static constexpr size_t ColumnCount = FrameColumns.size();
+
+    private:
+        size_t                                          capacity    = 0u;
+        size_t                                          rowCount    = 0u;
+        std::vector<std::uint8_t>                       body;       // laid out for a full batch, then packed down when encoded
+        FrameExportFormat::BatchLayout                  layout;
+
+    public:
+        constexpr explicit FrameBatch(size_t maxRows = DefaultGamesPerChunk * Game::FinalFrame)
+            : capacity(maxRows), body(FrameExportFormat::GetBatchLayout(maxRows).bodySize, 0u), layout(FrameExportFormat::GetBatchLayout(maxRows)) {
+        }
+
+        constexpr size_t GetRowCount() const {
+            return rowCount;
+        }
+
+        // whether another game's frames still fit
+        constexpr bool HasRoomForGame() const {
+            return rowCount + Game::FinalFrame <= capacity;
+        }
+
+        // empties the batch, keeping its buffers
+        constexpr void Clear() {
+            std::fill(body.begin(), body.end(), 0u);
+            rowCount = 0u;
+        }
+
+        // adds the frames of a complete game from its rolls and the scores of its regular frames
+        //-- the rolls have to be a complete, legal game, as the scorers report them
+        constexpr void AddGame(std::uint32_t game, std::span<const std::uint8_t> rolls, std::span<const std::uint8_t, Game::FinalFrame> currentScores,
+            std::span<const std::uint16_t, Game::FinalFrame> totalScores) {
+            Columns const columns = GetColumns();
+            size_t roll = 0u;
+            for (unsigned frame = 0u; frame < Game::FinalFrame; frame++) {
+                size_t const row = rowCount++;
+                unsigned const first = rolls[roll];
+                bool const isStrike = first == Game::NumPins;
+                bool const isFinal = frame == Game::FinalFrame - 1u;
+
+                Set<FrameColumn::Game>(columns, row, game);
+                Set<FrameColumn::Frame>(columns, row, frame);
+                Set<FrameColumn::PinsOnFirstRoll>(columns, row, first);
+                Set<FrameColumn::IsStrike>(columns, row, isStrike);
+                Set<FrameColumn::CurrentScore>(columns, row, currentScores[frame]);
+                Set<FrameColumn::TotalScore>(columns, row, totalScores[frame]);
+
+                bool isSpare = false;
+                if (!isStrike) {
+                    unsigned const second = rolls[roll + 1u];
+                    isSpare = first + second == Game::NumPins;
+                    Set<FrameColumn::PinsOnSecondRoll>(columns, row, second);
+                }
+                Set<FrameColumn::IsSpare>(columns, row, isSpare);
+
+                if (isFinal && isStrike) {
+                    Set<FrameColumn::PinsOnFirstBonusRoll>(columns, row, rolls[roll + 1u]);
+                    Set<FrameColumn::PinsOnSecondBonusRoll>(columns, row, rolls[roll + 2u]);
+                }
+                else if (isFinal && isSpare) {
+                    Set<FrameColumn::PinsOnFirstBonusRoll>(columns, row, rolls[roll + 2u]);
+                }
+                roll += isStrike ? 1u : 2u;
+            }
+        }
+
+        // adds a game that's over, as it's held in play; false if it isn't over yet
+        constexpr bool AddGame(std::uint32_t game, Game const& played) {
+            if (!played.IsGameComplete()) {
+                return false;
+            }
+
+            std::array<std::uint8_t, Game::MaxRolls> rolls{};
+            std::array<std::uint8_t, Game::FinalFrame> currentScores{};
+            std::array<std::uint16_t, Game::FinalFrame> totalScores{};
+            for (unsigned roll = 0u; roll < played.GetRollCount(); roll++) {
+                rolls[roll] = static_cast<std::uint8_t>(played.GetLoggedRoll(roll));
+            }
+            for (unsigned frame = 0u; frame < Game::FinalFrame; frame++) {
+                Frame const info = played.GetFrame(frame);
+                currentScores[frame] = static_cast<std::uint8_t>(info.currentScore);
+                totalScores[frame] = static_cast<std::uint16_t>(info.totalScore);
+            }
+            AddGame(game, std::span(rolls).first(played.GetRollCount()), currentScores, totalScores);
+
+            return true;
+        }
+
+        // appends the batch as the export lays it out, header and checksum included
+        constexpr void Encode(std::vector<std::uint8_t>& bytes) const {
+            FrameExportFormat::BatchLayout const packed = FrameExportFormat::GetBatchLayout(rowCount);
+            size_t const start = bytes.size();
+            bytes.resize(start + FrameExportFormat::BatchHeaderSize + packed.bodySize, 0u);
+
+            std::uint8_t* const out = bytes.data() + start + FrameExportFormat::BatchHeaderSize;
+            for (size_t column = 0u; column < ColumnCount; column++) {
+                if (FrameColumns[column].isNullable) {
+                    size_t const validityBytes = (rowCount + 7u) / 8u;
+                    std::copy_n(body.begin() + static_cast<std::ptrdiff_t>(layout.columns[column].validityOffset), validityBytes, out + packed.columns[column].validityOffset);
+                }
+                size_t const valueBytes = FrameExportFormat::GetValueSize(FrameColumns[column].type, rowCount);
+                std::copy_n(body.begin() + static_cast<std::ptrdiff_t>(layout.columns[column].valuesOffset), valueBytes, out + packed.columns[column].valuesOffset);
+            }
+
+            std::uint8_t* const header = bytes.data() + start;
+            FrameExportFormat::StoreLittleEndian(header + FrameExportFormat::RowCountOffset, static_cast<std::uint32_t>(rowCount));
+            FrameExportFormat::StoreLittleEndian(header + FrameExportFormat::BodySizeOffset, static_cast<std::uint32_t>(packed.bodySize));
+            FrameExportFormat::StoreLittleEndian(header + FrameExportFormat::ChecksumOffset, Crc32c().Update({ out, packed.bodySize }).Get());
+        }
+
+        // appends the batch header that ends an export
+        static constexpr void EncodeEnd(std::vector<std::uint8_t>& bytes) {
+            bytes.resize(bytes.size() + FrameExportFormat::BatchHeaderSize, 0u);
+        }
+
+    private:
+        // where every column's buffers start in the body
+        //-- held apart from the batch, since each byte stored through them could otherwise alias the body's own pointer
+        struct Columns {
+            std::array<std::uint8_t*, ColumnCount>  validity;
+            std::array<std::uint8_t*, ColumnCount>  values;
+        };
+
+        constexpr Columns GetColumns() {
+            Columns columns{};
+            for (size_t column = 0u; column < ColumnCount; column++) {
+                columns.validity[column] = body.data() + layout.columns[column].validityOffset;
+                columns.values[column] = body.data() + layout.columns[column].valuesOffset;
+            }
+
+            return columns;
+        }
+
+        // the column is picked at compile time, so every store is just the one for its type
+        template <FrameColumn Column>
+        static constexpr void Set(Columns const& columns, size_t row, unsigned value) {
+            constexpr size_t Index = static_cast<size_t>(Column);
+            constexpr ExportColumn Schema = FrameColumns[Index];
+            if constexpr (Schema.isNullable) {
+                columns.validity[Index][row / 8u] |= static_cast<std::uint8_t>(1u << (row % 8u));
+            }
+
+            std::uint8_t* const values = columns.values[Index];
+            if constexpr (Schema.type == ColumnType::Bool) {
+                values[row / 8u] |= static_cast<std::uint8_t>((value != 0u ? 1u : 0u) << (row % 8u));
+            }
+            else if constexpr (Schema.type == ColumnType::UInt8) {
+                values[row] = static_cast<std::uint8_t>(value);
+            }
+            else if constexpr (Schema.type == ColumnType::UInt16) {
+                FrameExportFormat::StoreLittleEndian(values + row * 2u, static_cast<std::uint16_t>(value));
+            }
+            else {
+                FrameExportFormat::StoreLittleEndian(values + row * 4u, static_cast<std::uint32_t>(value));
+            }
+        }
+    };
+
+    // Reads a frame export back a batch at a time, checking every batch against its checksum.
+    class FrameExportReader {
+    public:
+        // one batch's columns, read in place
+        class Batch {
+        private:
+            std::span<const std::uint8_t>       body;
+            size_t                              rowCount    = 0u;
+            FrameExportFormat::BatchLayout      layout;
+
+        public:
+            constexpr Batch(std::span<const std::uint8_t> batchBody, size_t rows)
+                : body(batchBody), rowCount(rows), layout(FrameExportFormat::GetBatchLayout(rows)) {
+            }
+
+            constexpr size_t GetRowCount() const {
+                return rowCount;
+            }
+
+            // a row's value in a column, or nothing if the row has none
+            constexpr std::optional<unsigned> GetValue(FrameColumn column, size_t row) const {
+                size_t const index = static_cast<size_t>(column);
+                ExportColumn const& schema = FrameColumns[index];
+                if (schema.isNullable && (body[layout.columns[index].validityOffset + row / 8u] >> (row % 8u) & 1u) == 0u) {
+                    return std::nullopt;
+                }
+
+                std::uint8_t const* const values = body.data() + layout.columns[index].valuesOffset;
+                switch (schema.type) {
+                case ColumnType::Bool:      return values[row / 8u] >> (row % 8u) & 1u;
+                case ColumnType::UInt8:     return values[row];
+                case ColumnType::UInt16:    return FrameExportFormat::LoadLittleEndian<std::uint16_t>(values + row * 2u);
+                case ColumnType::UInt32:    return FrameExportFormat::LoadLittleEndian<std::uint32_t>(values + row * 4u);
+                }
+
+                return std::nullopt;
+            }
+        };
+
+    private:
+        std::span<const std::uint8_t>   bytes;
+        size_t                          offset      = 0u;
+        bool                            isComplete  = false;
+
+    public:
+        // starts reading an export, or nothing if it doesn't have the columns this build writes
+        static constexpr std::optional<FrameExportReader> Open(std::span<const std::uint8_t> exportBytes) {
+            std::optional<size_t> const firstBatch = FrameExportFormat::DecodeHeader(exportBytes);
+            if (!firstBatch) {
+                return std::nullopt;
+            }
+
+            FrameExportReader reader;
+            reader.bytes = exportBytes;
+            reader.offset = *firstBatch;
+            return reader;
+        }
+
+        // the next batch, or nothing at the end of the export or at a truncated or damaged batch
+        constexpr std::optional<Batch> Next() {
+            if (isComplete || bytes.size() - offset < FrameExportFormat::BatchHeaderSize) {
+                return std::nullopt;
+            }
+
+            std::uint8_t const* const header = bytes.data() + offset;
+            std::uint32_t const rowCount = FrameExportFormat::LoadLittleEndian<std::uint32_t>(header + FrameExportFormat::RowCountOffset);
+            std::uint32_t const bodySize = FrameExportFormat::LoadLittleEndian<std::uint32_t>(header + FrameExportFormat::BodySizeOffset);
+            std::uint32_t const checksum = FrameExportFormat::LoadLittleEndian<std::uint32_t>(header + FrameExportFormat::ChecksumOffset);
+            if (rowCount == 0u) {
+                isComplete = true;
+                return std::nullopt;
+            }
+
+            std::span<const std::uint8_t> const body = bytes.subspan(offset + FrameExportFormat::BatchHeaderSize);
+            if (body.size() < bodySize || bodySize != FrameExportFormat::GetBatchLayout(rowCount).bodySize || Crc32c().Update(body.first(bodySize)).Get() != checksum) {
+                return std::nullopt;
+            }
+
+            offset += FrameExportFormat::BatchHeaderSize + bodySize;
+            return Batch(body.first(bodySize), rowCount);
+        }
+
+        // whether the export's end marker has been read, so no batch went missing from its tail
+        constexpr bool IsComplete() const {
+            return isComplete;
+        }
+    };
+
+    // Exports the frames of every complete game in an archive, in archive order, skipping games that aren't.
+    //-- batches score through the batch kernel and encode in parallel, like RescoreArchive(), a window of them at a time:
+    //-- each window is written out in order before the next is scored, so memory stays at a window of batches
+    //-- whatever the archive's size; returns false if the stream fails
+    template <GameArchive Archive>
+    bool ExportArchiveFrames(Archive const& archive, std::ostream& out, WorkStealingPool& pool, size_t gamesPerBatch = DefaultGamesPerChunk) {
+        using Scorer = BatchScorer<>;
+
+        size_t const gameCount = archive.GetGameCount();
+        size_t const batchCount = (gameCount + gamesPerBatch - 1u) / gamesPerBatch;
+        size_t const windowSize = std::min<size_t>(batchCount, 2u * pool.GetThreadCount());
+
+        std::vector<std::uint8_t> bytes;
+        FrameExportFormat::EncodeHeader(bytes);
+        out.write(reinterpret_cast<char const*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+
+        std::vector<FrameBatch> batches(windowSize, FrameBatch(gamesPerBatch * Game::FinalFrame));
+        std::vector<std::vector<std::uint8_t>> encoded(windowSize);
+        for (size_t windowStart = 0u; windowStart < batchCount && out; windowStart += windowSize) {
+            size_t const windowBatches = std::min(windowSize, batchCount - windowStart);
+            pool.ParallelFor(windowBatches, [&](size_t slot) {
+                size_t const first = (windowStart + slot) * gamesPerBatch;
+                size_t const end = std::min(gameCount, first + gamesPerBatch);
+                FrameBatch& batch = batches[slot];
+                batch.Clear();
+
+                std::array<std::uint8_t, Game::MaxRolls + 1u> buffer;
+                Scorer::Rolls rolls;
+                Scorer::Scores laneScores;
+                for (size_t group = first; group < end; group += Scorer::Lanes) {
+                    size_t const laneCount = std::min(Scorer::Lanes, end - group);
+                    for (size_t lane = 0u; lane < Scorer::Lanes; lane++) {
+                        rolls.SetGame(lane, lane < laneCount ? archive.GetGameRolls(group + lane, buffer) : std::span<const std::uint8_t>());
+                    }
+
+                    Scorer::Score(rolls, laneScores);
+
+                    // the kernel keeps each game's rolls and scores lane by lane, so gather every valid lane's back up
+                    for (size_t lane = 0u; lane < laneCount; lane++) {
+                        if (laneScores.isValid[lane] == 0u) {
+                            continue;
+                        }
+
+                        std::array<std::uint8_t, Game::MaxRolls> gameRolls;
+                        std::array<std::uint8_t, Game::FinalFrame> currentScores;
+                        std::array<std::uint16_t, Game::FinalFrame> totalScores;
+                        for (size_t roll = 0u; roll < rolls.rollCounts[lane]; roll++) {
+                            gameRolls[roll] = rolls.pins[roll][lane];
+                        }
+                        for (unsigned frame = 0u; frame < Game::FinalFrame; frame++) {
+                            currentScores[frame] = laneScores.currentScore[frame][lane];
+                            totalScores[frame] = laneScores.totalScore[frame][lane];
+                        }
+                        batch.AddGame(static_cast<std::uint32_t>(group + lane), std::span(gameRolls).first(rolls.rollCounts[lane]), currentScores, totalScores);
+                    }
+                }
+
+                encoded[slot].clear();
+                if (batch.GetRowCount() > 0u) {
+                    batch.Encode(encoded[slot]);
+                }
+            });
+
+            for (size_t slot = 0u; slot < windowBatches; slot++) {
+                out.write(reinterpret_cast<char const*>(encoded[slot].data()), static_cast<std::streamsize>(encoded[slot].size()));
+            }
+        }
+
+        bytes.clear();
+        FrameBatch::EncodeEnd(bytes);
+        out.write(reinterpret_cast<char const*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+
+        return static_cast<bool>(out);
+    }
+
+    // exports the frames of every game in the pool that's over, by slot, in batches of up to the given number of games
+    //-- games still being bowled are left out; returns false if the stream fails
+    template <size_t Capacity>
+    bool ExportPoolFrames(GamePool<Capacity> const& pool, std::ostream& out, size_t gamesPerBatch = DefaultGamesPerChunk) {
+        std::vector<std::uint8_t> bytes;
+        FrameExportFormat::EncodeHeader(bytes);
+
+        FrameBatch batch(std::max<size_t>(gamesPerBatch, 1u) * Game::FinalFrame);
+        auto const flush = [&] {
+            if (batch.GetRowCount() > 0u) {
+                batch.Encode(bytes);
+                batch.Clear();
+            }
+            out.write(reinterpret_cast<char const*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+            bytes.clear();
+        };
+
+        pool.ForEachActive([&](GameHandle handle, Game const& game) {
+            if (batch.AddGame(handle.index, game) && !batch.HasRoomForGame()) {
+                flush();
+            }
+        });
+        flush();
+
+        FrameBatch::EncodeEnd(bytes);
+        out.write(reinterpret_cast<char const*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+
+        return static_cast<bool>(out);
+    }
+} // namespace ExperisBowling
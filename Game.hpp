@@ -1,47 +1,455 @@
 #pragma once
 
+#include <algorithm>
+#include "AllocTracking.hpp"
 #include <array>
+#include <atomic>
+#include <bit>
+#include "Crc32.hpp"
+#include <cstdint>
 #include <format>
+#include "GameRules.hpp"
+#include "Instrumentation.hpp"
 #include <optional>
-#include <ranges>
+#include <span>
+#include <string>
+#include <type_traits>
 
 namespace ExperisBowling {
+    // reasons a roll can be rejected
+    enum class RollError : std::uint8_t {
+        None,
+        GameComplete,
+        InvalidPinCount,
+        InvalidSpare,
+        NoSuchRoll,
+    };
+
+    // compact, trivially-copyable outcome of a roll - stands in for std::expected<void, RollError>
+    //-- the message text is only formatted when someone asks for it, so rejected rolls never allocate
+    struct RollResult {
+        RollError       error           = RollError::None;
+        unsigned        pinCount        = 0u;       // the pin count that was attempted
+        std::uint16_t   changedFrames   = 0u;       // bit i is set if frame i changed, so displays can redraw just those
+
+        constexpr explicit operator bool() const {
+            return error == RollError::None;
+        }
+
+        // builds the user-facing error message, if there is one
+        constexpr std::optional<std::string> ToMessage() const {
+            switch (error) {
+            case RollError::None:               return std::nullopt;
+            case RollError::GameComplete:       return "Game complete.";
+            case RollError::InvalidPinCount:    return std::format("Invalid roll - Pin count: {}", pinCount);
+            case RollError::InvalidSpare:       return "Invalid spare roll\n";
+            case RollError::NoSuchRoll:         return "No such roll to amend.";
+            }
+
+            return std::nullopt;
+        }
+    };
+
+    // data to represent a single frame in a bowling game
+    struct Frame {
+        int                     bonusRolls          = 0;        // count of how many bonus rolls we have
+        unsigned                currentScore        = 0u;       // the score for the current round (not the total sum)
+        bool                    isSpare             = false;    // flagging whether a spare occurred
+        bool                    isStrike            = false;    // flagging whether a strike occurred
+        std::optional<unsigned> pinsOnFirstRoll;                // how many pins we got in the first roll, if we played it
+        std::optional<unsigned> pinsOnSecondRoll;               // how many pins we got in the second roll, if we played it
+        std::optional<unsigned> pinsOnThirdRoll;                // how many pins we got in the third roll, for rules with three balls per frame
+        unsigned                totalScore          = 0u;       // the accumulative score up to this point
+
+        constexpr bool operator==(Frame const&) const = default;
+    };
+
+    // Resolves the bonus rolls that earlier strikes and spares are waiting on, branching on each prior frame.
+    //-- scoring engines are policies of BasicGame, which lets them reach into its frames
+    struct BranchingScoring {
+        template <class Game>
+        static constexpr void ResolveBonuses(Game& game, unsigned pinCount) {
+            auto& frames = game.frames;
+            unsigned const currentRound = game.currentRound;
+
+            // compute bonus points from two frames prior
+            if (currentRound >= 2u && frames[currentRound - 2u].bonusRolls > 0u) {
+                auto& priorFrame = frames[currentRound - 2u];
+                priorFrame.currentScore += pinCount;
+                priorFrame.bonusRolls -= 1u;
+                game.provisionalScore += static_cast<std::uint16_t>(pinCount);
+
+                if (priorFrame.bonusRolls == 0u) {
+                    // are there any additional frames to sum with the current score?
+                    if (currentRound >= 3u) { 
+                        priorFrame.totalScore = frames[currentRound - 3u].totalScore + priorFrame.currentScore;
+                    }
+                    else { // no extra frames
+                        priorFrame.totalScore = priorFrame.currentScore;
+                    }
+                    game.finalizedScore = static_cast<std::uint16_t>(priorFrame.totalScore);
+                }
+            }
+
+            // compute bonus points from the previous frame
+            if (currentRound >= 1u && frames[currentRound - 1u].bonusRolls > 0u) {
+                auto& prevFrame = frames[currentRound - 1u];
+                prevFrame.currentScore += pinCount;
+                prevFrame.bonusRolls -= 1u;
+                if (currentRound - 1u <= Game::FinalFrame - 1u) { // bonus frames don't count towards the score
+                    game.provisionalScore += static_cast<std::uint16_t>(pinCount);
+                }
+
+                if (prevFrame.bonusRolls == 0u) {
+                    if (currentRound >= 2u) {
+                        prevFrame.totalScore = frames[currentRound - 2u].totalScore + prevFrame.currentScore;
+                    }
+                    else {
+                        prevFrame.totalScore = prevFrame.currentScore;
+                    }
+                    game.finalizedScore = static_cast<std::uint16_t>(prevFrame.totalScore);
+                }
+            }
+        }
+    };
+
     // Tracks score for a simple game of bowling.
-    class Game {
+    //-- the rules decide the pins, frames and bonuses, see GameRules.hpp
+    //-- the scoring engine decides how bonus rolls are resolved, see BranchingScoring and TableScoring
+    template <GameRules Rules = TenPinRules, class ScoringEngine = BranchingScoring>
+    class BasicGame {
     public:
         // constants to avoid hard-coded numbers, make code more self-documenting
-        static constexpr unsigned FinalFrame = 10u;
+        static constexpr unsigned FinalFrame = Rules::NumFrames;
         static constexpr unsigned FirstBonusFrame = FinalFrame + 1u;
         static constexpr unsigned SecondBonusFrame = FinalFrame + 2u;
         static constexpr unsigned MaxFrames = FinalFrame + 2u;
-        static constexpr unsigned NumPins = 10u;
-
-        static constexpr int SpareBonusRolls = 1;
-        static constexpr int StrikeBonusRolls = 2;
-
-        // data to represent a single frame in a bowling game
-        struct Frame {
-            int                     bonusRolls          = 0;        // count of how many bonus rolls we have
-            unsigned                currentScore        = 0u;       // the score for the current round (not the total sum)
-            bool                    isSpare             = false;    // flagging whether a spare occurred
-            bool                    isStrike            = false;    // flagging whether a strike occurred
-            std::optional<unsigned> pinsOnFirstRoll;                // how many pins we got in the first roll, if we played it
-            std::optional<unsigned> pinsOnSecondRoll;               // how many pins we got in the second roll, if we played it
-            unsigned                totalScore          = 0u;       // the accumulative score up to this point
-        };
+        static constexpr unsigned NumPins = Rules::NumPins;
+        static constexpr unsigned BallsPerFrame = Rules::BallsPerFrame;
+
+        // the rules this game is played by, for code that's generic over games
+        using RulesPolicy = Rules;
+
+        static constexpr int SpareBonusRolls = static_cast<int>(Rules::SpareBonusRolls);
+        static constexpr int StrikeBonusRolls = static_cast<int>(Rules::StrikeBonusRolls);
+
+        // the most rolls the final frame can take, counting the bonus rolls it earns
+        static constexpr unsigned MaxFinalFrameRolls = std::max({ BallsPerFrame, 1u + Rules::StrikeBonusRolls,
+            BallsPerFrame >= 2u ? 2u + Rules::SpareBonusRolls : 0u });
+        static constexpr unsigned MaxRolls = (FinalFrame - 1u) * BallsPerFrame + MaxFinalFrameRolls;
+
+        // every scoring engine shares the same public view of a frame
+        using Frame = ExperisBowling::Frame;
 
     private:
-        unsigned                        currentRound = 0u;
-        std::array<Frame, MaxFrames>    frames;
+        friend ScoringEngine;
+
+        // how many bits each part of a frame needs under these rules
+        //-- one roll value is kept free to mark an unplayed roll, and a strike followed by strikes is the best a frame can score
+        static constexpr unsigned RollBits = static_cast<unsigned>(std::bit_width(NumPins + 1u));
+        static constexpr unsigned FrameScoreBits = static_cast<unsigned>(std::bit_width(NumPins * (1u + std::max(Rules::StrikeBonusRolls, Rules::SpareBonusRolls))));
+        static constexpr unsigned TotalScoreBits = static_cast<unsigned>(std::bit_width(FinalFrame * NumPins * (1u + std::max(Rules::StrikeBonusRolls, Rules::SpareBonusRolls))));
+        static constexpr unsigned LoggedRollsPerFrame = (MaxRolls + MaxFrames - 1u) / MaxFrames;
+        static constexpr unsigned FrameBits = RollBits * BallsPerFrame + 2u + FrameScoreBits + TotalScoreBits + RollBits * LoggedRollsPerFrame;
+
+        // the smallest word every frame fits in
+        using FrameWord = std::conditional_t<FrameBits <= 32u, std::uint32_t, std::uint64_t>;
+
+        static_assert(FrameBits <= 64u, "a frame has to fit in a 64-bit word");
+
+        // bit-packed storage for a single frame, decoded into a Frame on request
+        //-- for ten-pin each roll fits in 4 bits and each score in 9, so the whole game fits in one cache line
+        //-- the bits left over in every frame hold entries of the game's roll log, see GetLoggedRoll()
+        struct PackedFrame {
+            static constexpr unsigned NoRoll = (1u << RollBits) - 1u; // marks a roll that hasn't been played yet
+            static constexpr FrameWord RollMask = NoRoll;
+
+            FrameWord   rolls               : RollBits * BallsPerFrame      = (FrameWord{ 1u } << (RollBits * BallsPerFrame)) - 1u;
+            FrameWord   bonusRolls          : 2                             = 0u;
+            FrameWord   currentScore        : FrameScoreBits                = 0u;
+            FrameWord   totalScore          : TotalScoreBits                = 0u;
+            FrameWord   rollLog             : RollBits * LoggedRollsPerFrame = 0u;  // not part of this frame, just stored alongside it
+
+            // compares the frame itself, leaving out the roll log it carries
+            constexpr bool operator==(PackedFrame const& other) const {
+                return rolls == other.rolls && bonusRolls == other.bonusRolls && currentScore == other.currentScore && totalScore == other.totalScore;
+            }
+
+            // the pins knocked down by one ball, or NoRoll
+            constexpr unsigned GetRoll(unsigned ball) const {
+                return static_cast<unsigned>(rolls >> (ball * RollBits) & RollMask);
+            }
+
+            constexpr void SetRoll(unsigned ball, unsigned pinCount) {
+                rolls = (rolls & ~(RollMask << (ball * RollBits))) | static_cast<FrameWord>(pinCount) << (ball * RollBits);
+            }
+
+            constexpr bool HasRoll(unsigned ball) const {
+                return GetRoll(ball) != NoRoll;
+            }
+
+            constexpr bool HasFirstRoll() const {
+                return HasRoll(0u);
+            }
+
+            constexpr bool HasSecondRoll() const {
+                return BallsPerFrame >= 2u && HasRoll(1u);
+            }
+
+            // pin counts treating an unplayed roll as zero
+            constexpr unsigned RollOrZero(unsigned ball) const {
+                return HasRoll(ball) ? GetRoll(ball) : 0u;
+            }
+
+            constexpr unsigned FirstRollOrZero() const {
+                return RollOrZero(0u);
+            }
+
+            constexpr unsigned SecondRollOrZero() const {
+                return BallsPerFrame >= 2u ? RollOrZero(1u) : 0u;
+            }
+
+            // how many balls have been rolled in this frame, which are always the first ones
+            constexpr unsigned GetBallCount() const {
+                unsigned balls = 0u;
+                while (balls < BallsPerFrame && HasRoll(balls)) {
+                    balls++;
+                }
+
+                return balls;
+            }
+
+            // how many pins have been knocked down in this frame so far
+            constexpr unsigned GetPinsDown() const {
+                unsigned pins = 0u;
+                for (unsigned ball = 0u; ball < BallsPerFrame; ball++) {
+                    pins += RollOrZero(ball);
+                }
+
+                return pins;
+            }
+
+            // the bonus rolls this frame earned by how it was cleared, if it was
+            constexpr unsigned GetEarnedBonusRolls() const {
+                if (GetPinsDown() != NumPins) {
+                    return 0u;
+                }
+                unsigned const balls = GetBallCount();
+
+                return balls == 1u ? Rules::StrikeBonusRolls : balls == 2u ? Rules::SpareBonusRolls : 0u;
+            }
+
+            // expands the packed bits into the public frame view
+            constexpr Frame Unpack() const {
+                Frame frame;
+                frame.bonusRolls = static_cast<int>(bonusRolls);
+                frame.currentScore = static_cast<unsigned>(currentScore);
+                frame.isStrike = GetRoll(0u) == NumPins;
+                frame.isSpare = HasSecondRoll() && FirstRollOrZero() + GetRoll(1u) == NumPins;
+                if (HasFirstRoll()) {
+                    frame.pinsOnFirstRoll = GetRoll(0u);
+                }
+                if (HasSecondRoll()) {
+                    frame.pinsOnSecondRoll = GetRoll(1u);
+                }
+                if (BallsPerFrame >= 3u && HasRoll(2u)) {
+                    frame.pinsOnThirdRoll = GetRoll(2u);
+                }
+                frame.totalScore = static_cast<unsigned>(totalScore);
+
+                return frame;
+            }
+
+            // the frame as a plain word, its parts laid out from the lowest bit in the order they're declared in
+            //-- spelled out rather than bit-cast, since how bit-fields are laid out is up to the compiler
+            constexpr FrameWord ToWord() const {
+                return FrameWord{ rolls } | FrameWord{ bonusRolls } << BonusRollsShift | FrameWord{ currentScore } << CurrentScoreShift
+                    | FrameWord{ totalScore } << TotalScoreShift | FrameWord{ rollLog } << RollLogShift;
+            }
+
+            static constexpr PackedFrame FromWord(FrameWord word) {
+                PackedFrame frame;
+                frame.rolls = word & GetMask(RollBits * BallsPerFrame);
+                frame.bonusRolls = word >> BonusRollsShift & GetMask(2u);
+                frame.currentScore = word >> CurrentScoreShift & GetMask(FrameScoreBits);
+                frame.totalScore = word >> TotalScoreShift & GetMask(TotalScoreBits);
+                frame.rollLog = word >> RollLogShift & GetMask(RollBits * LoggedRollsPerFrame);
+
+                return frame;
+            }
+
+        private:
+            static constexpr unsigned BonusRollsShift = RollBits * BallsPerFrame;
+            static constexpr unsigned CurrentScoreShift = BonusRollsShift + 2u;
+            static constexpr unsigned TotalScoreShift = CurrentScoreShift + FrameScoreBits;
+            static constexpr unsigned RollLogShift = TotalScoreShift + TotalScoreBits;
+
+            static constexpr FrameWord GetMask(unsigned bits) {
+                return (FrameWord{ 1u } << bits) - 1u;
+            }
+        };
+        static_assert(sizeof(PackedFrame) == sizeof(FrameWord));
+        static_assert(MaxFrames <= 16u, "changed frames are reported in a 16-bit mask");
+
+        std::uint32_t                       version = 0u;           // odd while the game is being changed, see Snapshot()
+        std::uint16_t                       finalizedScore = 0u;    // total of the latest frame whose score is final
+        std::uint16_t                       provisionalScore = 0u;  // every pin counted so far, including bonuses still pending
+        std::uint8_t                        currentRound = 0u;
+        std::uint8_t                        rollCount = 0u;         // rolls currently played
+        std::uint8_t                        loggedRolls = 0u;       // rolls in the log, counting undone ones that can be redone
+        std::array<PackedFrame, MaxFrames>  frames;
 
     public:
+        // Fixed-size, versioned image of everything a game has played, for bringing it back after a restart.
+        //-- trivially copyable and free of padding, so checkpoints can be written out or mapped as they are
+        //-- multi-byte fields are little-endian, and the checksum is a CRC-32C over every field after it
+        struct Checkpoint {
+            static constexpr std::array<char, 4u> Magic = { 'E', 'B', 'G', 'C' };
+            static constexpr std::uint8_t CurrentVersion = 1u;
+
+            std::array<char, 4u>                magic               = {};
+            std::uint8_t                        formatVersion       = 0u;
+            std::uint8_t                        numFrames           = 0u;   // the rules the game was played by
+            std::uint8_t                        numPins             = 0u;
+            std::uint8_t                        ballsPerFrame       = 0u;
+            std::uint32_t                       checksum            = 0u;
+            std::uint16_t                       finalizedScore      = 0u;
+            std::uint16_t                       provisionalScore    = 0u;
+            std::uint8_t                        currentRound        = 0u;
+            std::uint8_t                        rollCount           = 0u;
+            std::uint8_t                        loggedRolls         = 0u;
+            std::uint8_t                        reserved            = 0u;
+            std::uint32_t                       reservedWord        = 0u;   // keeps the frames on an 8-byte boundary
+            std::array<FrameWord, MaxFrames>    frames              = {};   // pending bonus rolls are part of each frame
+        };
+        static_assert(std::is_trivially_copyable_v<Checkpoint> && std::has_unique_object_representations_v<Checkpoint>);
+
+        // builds a game from a whole roll sequence, if every roll in it is valid
+        static constexpr std::optional<BasicGame> FromRolls(std::span<const std::uint8_t> rolls) {
+            BasicGame game;
+            if (!game.LayOutRolls(rolls)) { // no other thread can see the game yet, so it's played in place
+                return std::nullopt;
+            }
+
+            return game;
+        }
+
+        // compares the state of play, ignoring how many changes it took to get there
+        constexpr bool operator==(BasicGame const& other) const {
+            return currentRound == other.currentRound && finalizedScore == other.finalizedScore
+                && provisionalScore == other.provisionalScore && frames == other.frames;
+        }
+
         // validates whether a particular roll is possible this round
         constexpr bool CheckRoll(unsigned pinCount, unsigned round) const {
-            if (!frames[round].pinsOnFirstRoll) { // do we have a normal pin count for the first roll?
-                return pinCount <= NumPins;
+            return pinCount <= GetStandingPins(round);
+        }
+
+        // retrieves how many pins a roll in the given round would be thrown at
+        constexpr unsigned GetStandingPins(unsigned round) const {
+            // the second of two bonus rolls is thrown at whatever the first one left standing
+            if (round == SecondBonusFrame - 1u && frames[FinalFrame - 1u].GetEarnedBonusRolls() >= 2u && !IsStrike(FirstBonusFrame - 1u)) {
+                return NumPins - frames[FirstBonusFrame - 1u].GetRoll(0u);
+            }
+
+            return NumPins - frames[round].GetPinsDown(); // a frame with no rolls yet has every pin standing
+        }
+
+        // retrieves the most pins the next roll can knock down, or 0 once the game is complete
+        constexpr unsigned GetStandingPins() const {
+            return IsGameComplete() ? 0u : GetStandingPins(currentRound);
+        }
+
+        // Copies the game while another thread may be rolling on it, without blocking either side.
+        //-- every change to the game makes its version odd until the change is done, so the copy is retried
+        //-- until it started and ended on the same even version; the writer itself never waits on readers
+        BasicGame Snapshot() const {
+            BasicGame copy;
+            while (true) {
+                std::uint32_t const start = LoadShared(version, std::memory_order_acquire);
+                if ((start & 1u) != 0u) {
+                    continue;
+                }
+
+                copy.currentRound = LoadShared(currentRound, std::memory_order_relaxed);
+                copy.rollCount = LoadShared(rollCount, std::memory_order_relaxed);
+                copy.loggedRolls = LoadShared(loggedRolls, std::memory_order_relaxed);
+                copy.finalizedScore = LoadShared(finalizedScore, std::memory_order_relaxed);
+                copy.provisionalScore = LoadShared(provisionalScore, std::memory_order_relaxed);
+                for (size_t i = 0u; i < MaxFrames; i++) {
+                    copy.frames[i] = LoadShared(frames[i], std::memory_order_relaxed);
+                }
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (LoadShared(version, std::memory_order_relaxed) == start) {
+                    copy.version = start;
+                    return copy;
+                }
+            }
+        }
+
+        // retrieves how many changes have been made to the game, which lets readers skip redrawing an unchanged one
+        std::uint32_t GetVersion() const {
+            return LoadShared(version, std::memory_order_acquire) / 2u;
+        }
+
+        // captures the game for restoring later, see Checkpoint
+        //-- a game another thread may be rolling on should be captured from a Snapshot() of it
+        constexpr Checkpoint SaveCheckpoint() const {
+            Checkpoint checkpoint;
+            checkpoint.magic = Checkpoint::Magic;
+            checkpoint.formatVersion = Checkpoint::CurrentVersion;
+            checkpoint.numFrames = static_cast<std::uint8_t>(FinalFrame);
+            checkpoint.numPins = static_cast<std::uint8_t>(NumPins);
+            checkpoint.ballsPerFrame = static_cast<std::uint8_t>(BallsPerFrame);
+            checkpoint.finalizedScore = ToLittleEndian(finalizedScore);
+            checkpoint.provisionalScore = ToLittleEndian(provisionalScore);
+            checkpoint.currentRound = currentRound;
+            checkpoint.rollCount = rollCount;
+            checkpoint.loggedRolls = loggedRolls;
+            for (size_t i = 0u; i < MaxFrames; i++) {
+                checkpoint.frames[i] = ToLittleEndian(frames[i].ToWord());
+            }
+            checkpoint.checksum = ToLittleEndian(GetChecksum(checkpoint));
+
+            return checkpoint;
+        }
+
+        // restores the game from a checkpoint, keeping its version counting so concurrent snapshots notice
+        //-- returns false and leaves the game as it was if the checkpoint is damaged or from other rules or a later format
+        //-- takes the same time whatever the checkpoint holds, since nothing is replayed and every check always runs
+        constexpr bool RestoreCheckpoint(Checkpoint const& checkpoint) {
+            if (!IsRestorable(checkpoint)) {
+                return false;
+            }
+
+            BasicGame restored;
+            restored.finalizedScore = ToLittleEndian(checkpoint.finalizedScore);
+            restored.provisionalScore = ToLittleEndian(checkpoint.provisionalScore);
+            restored.currentRound = checkpoint.currentRound;
+            restored.rollCount = checkpoint.rollCount;
+            restored.loggedRolls = checkpoint.loggedRolls;
+            for (size_t i = 0u; i < MaxFrames; i++) {
+                restored.frames[i] = PackedFrame::FromWord(ToLittleEndian(checkpoint.frames[i]));
+            }
+            Publish(restored);
+
+            return true;
+        }
+
+        // builds a game from a checkpoint, if it's one RestoreCheckpoint() accepts
+        static constexpr std::optional<BasicGame> FromCheckpoint(Checkpoint const& checkpoint) {
+            BasicGame game;
+            if (!game.RestoreCheckpoint(checkpoint)) {
+                return std::nullopt;
             }
 
-            return frames[round].pinsOnFirstRoll.value() + pinCount <= NumPins;
+            return game;
+        }
+
+        // starts the game over, keeping its version counting so concurrent snapshots notice
+        constexpr void Reset() {
+            Publish(BasicGame());
         }
 
         // retrieves the index of the current game round
@@ -50,154 +458,639 @@ namespace ExperisBowling {
         }
 
         // get any frame info by its index
-        constexpr Frame const& GetFrame(size_t i) const {
-            return frames[i];
+        //-- returns a decoded copy since frames are stored bit-packed
+        constexpr Frame GetFrame(size_t i) const {
+            return frames[i].Unpack();
         }
 
-        // retrieves the current total score
+        // retrieves the total score of every frame that has been finalized so far
         constexpr unsigned GetScore() const {
-            // seek backwards through the frames for the score
-            for (Frame const& frame : frames | std::views::reverse) {
-                if (frame.totalScore > 0u) {
-                    return frame.totalScore;
+            EXPERIS_PROBE(GetScore);
+            return finalizedScore;
+        }
+
+        // retrieves the score so far, counting frames and bonuses that are still waiting on rolls
+        constexpr unsigned GetProvisionalScore() const {
+            return provisionalScore;
+        }
+
+        // retrieves the lowest final score still reachable, which is the score so far if every remaining roll misses
+        constexpr unsigned GetMinPossibleScore() const {
+            return provisionalScore;
+        }
+
+        // retrieves the highest final score still reachable, by clearing the pins with every remaining roll
+        constexpr unsigned GetMaxPossibleScore() const {
+            return PlayOutScore([](unsigned standingPins) { return standingPins; });
+        }
+
+        // retrieves the final score the game would reach if every remaining roll knocked down nextRoll(standing pins)
+        //-- plays the remaining rolls out on a handful of counters rather than a copy of the game, so it's O(rolls)
+        //-- nextRoll must return a legal pin count, no more than the pins it's given
+        template <class NextRoll>
+        constexpr unsigned PlayOutScore(NextRoll&& nextRoll) const {
+            unsigned score = provisionalScore;
+            unsigned round = currentRound;
+
+            // how many regular frames are still owed the next roll, and the one after it
+            std::array<unsigned, 2u> owed{};
+            for (unsigned back = 1u; back <= 2u && back <= round; back++) {
+                if (round - back < FinalFrame) {
+                    owed[0] += frames[round - back].bonusRolls > 0u;
+                    owed[1] += frames[round - back].bonusRolls > 1u;
                 }
             }
 
-            return frames[0].currentScore;
+            // finish the regular frames, starting from the pins left standing in the current one
+            unsigned pinsDown = round < FinalFrame ? frames[round].GetPinsDown() : 0u;
+            unsigned balls = round < FinalFrame ? frames[round].GetBallCount() : 0u;
+            unsigned bonusRolls = round < FinalFrame ? 0u : static_cast<unsigned>(frames[FinalFrame - 1u].bonusRolls);
+            for (; round < FinalFrame; round++) {
+                do {
+                    unsigned const pinCount = nextRoll(NumPins - pinsDown);
+                    score += pinCount * (1u + owed[0]);
+                    owed = { owed[1], 0u };
+                    pinsDown += pinCount;
+                    balls++;
+                } while (pinsDown < NumPins && balls < BallsPerFrame);
+
+                bonusRolls = pinsDown < NumPins ? 0u : balls == 1u ? Rules::StrikeBonusRolls : balls == 2u ? Rules::SpareBonusRolls : 0u;
+                owed = { owed[0] + (bonusRolls > 0u), owed[1] + (bonusRolls > 1u) };
+                pinsDown = 0u;
+                balls = 0u;
+            }
+
+            // then the final frame's bonus rolls, which only count towards the frames still owed them
+            //-- a bonus roll after a strike in the final frame may find pins already down from the first bonus roll
+            unsigned standingPins = NumPins;
+            if (currentRound == SecondBonusFrame - 1u && !IsStrike(FirstBonusFrame - 1u)) {
+                standingPins = NumPins - frames[FirstBonusFrame - 1u].FirstRollOrZero();
+            }
+            for (; bonusRolls > 0u; bonusRolls--) {
+                unsigned const pinCount = nextRoll(standingPins);
+                score += pinCount * owed[0];
+                owed = { owed[1], 0u };
+                standingPins = pinCount == standingPins ? NumPins : standingPins - pinCount;
+            }
+
+            return score;
+        }
+
+        // checks whether this game can still finish ahead of an opponent's, if the rest of the rolls go its way
+        //-- that is, its best possible score beats the least the opponent can still end up with
+        constexpr bool CanStillWin(BasicGame const& opponent) const {
+            return GetMaxPossibleScore() > opponent.GetMinPossibleScore();
         }
 
         // returns whether the bowling game has finished
+        //-- the final frame owes bonus rolls from the moment it's cleared until they've all been played
         constexpr bool IsGameComplete() const {
-            if (currentRound <= FinalFrame - 1u) {
-                return false;
+            EXPERIS_PROBE(IsGameComplete);
+            return currentRound >= FinalFrame && frames[FinalFrame - 1u].bonusRolls == 0u;
+        }
+
+        // tells the bowling game how many pins were knocked down by the latest roll
+        //-- using std::optional as a stand-in for C++23 error-handling with std::expected
+        constexpr std::optional<std::string> Roll(unsigned pinCount) {
+            return TryRoll(pinCount).ToMessage();
+        }
+
+        // allocation-free version of Roll() - reports failures as an error code instead of a string
+        constexpr RollResult TryRoll(unsigned pinCount) {
+            EXPERIS_NO_ALLOC_SCOPE();
+            EXPERIS_PROBE(Roll);
+            if (RollResult const result = CheckPlayable(pinCount); !result) {
+                EXPERIS_COUNT_IF(InvalidRoll, true);
+                return result;
             }
-            if (currentRound == FirstBonusFrame - 1u) {
-                return !IsSpare(FinalFrame - 1u) && !IsStrike(FinalFrame - 1u);
+
+            std::uint16_t const changedFrames = GetFramesChangedByNextRoll();
+            EXPERIS_COUNT_IF(ValidRoll, true);
+            EXPERIS_COUNT_IF(Strike, frames[currentRound].GetBallCount() == 0u && pinCount == NumPins);
+            EXPERIS_COUNT_IF(Spare, frames[currentRound].GetBallCount() == 1u && frames[currentRound].GetPinsDown() + pinCount == NumPins);
+
+            BasicGame next = *this;
+            next.PlayRoll(pinCount);
+            next.SetLoggedRoll(rollCount, pinCount);
+            next.rollCount++;
+            next.loggedRolls = next.rollCount; // a new roll replaces anything that could have been redone
+            Publish(next, changedFrames | 1u << (rollCount / LoggedRollsPerFrame));
+
+            return { RollError::None, pinCount, changedFrames };
+        }
+
+        // takes back the latest roll, keeping it in the log so Redo() can play it again
+        constexpr bool Undo() {
+            if (rollCount == 0u) {
+                return false;
             }
-            if (currentRound == SecondBonusFrame - 1u) {
-                return !(IsStrike(FinalFrame - 1u) && frames[FinalFrame - 1u].bonusRolls > 0u);
+
+            BasicGame next = *this;
+            unsigned const lastRoll = rollCount - 1u;
+            next.Rewind(FindRollFrame(lastRoll));
+            next.ReplayLog(lastRoll);
+            Publish(next);
+
+            return true;
+        }
+
+        // plays the most recently undone roll again
+        constexpr bool Redo() {
+            if (rollCount == loggedRolls) {
+                return false;
             }
 
+            BasicGame next = *this;
+            next.PlayRoll(GetLoggedRoll(rollCount));
+            next.rollCount++;
+            Publish(next);
+
             return true;
         }
 
-        // tells the bowling game how many pins were knocked down by the latest roll
-        //-- using std::optional as a stand-in for C++23 error-handling with std::expected
-        constexpr std::optional<std::string> Roll(unsigned pinCount) {
-            if (IsGameComplete()) {
-                return "Game complete.";
+        // corrects the pin count of an earlier roll, re-scoring from the frame it was played in
+        //-- only the two frames before that one can depend on it, so every frame earlier is left untouched
+        //-- the game is left unchanged if any later roll becomes invalid, and undone rolls can no longer be redone
+        constexpr RollResult Amend(unsigned rollIndex, unsigned pinCount) {
+            EXPERIS_NO_ALLOC_SCOPE();
+            if (rollIndex >= rollCount) {
+                return { RollError::NoSuchRoll, pinCount };
             }
-            if (pinCount > NumPins || !CheckRoll(pinCount, currentRound)) {
-                return std::format("Invalid roll - Pin count: {}", pinCount);
+            if (pinCount > NumPins) {
+                return { RollError::InvalidPinCount, pinCount };
             }
 
-            // add in points until the final frame
-            if (currentRound <= FinalFrame - 1u) {
-                frames[currentRound].currentScore += pinCount;
+            // replay on a copy first, so a rejected amendment can't leave the game half re-scored
+            BasicGame amended = *this;
+            unsigned const playedRolls = rollCount;
+            amended.Rewind(FindRollFrame(rollIndex));
+            amended.SetLoggedRoll(rollIndex, pinCount);
+            if (RollResult const result = amended.ReplayLog(playedRolls); !result) {
+                return result;
             }
 
-            // compute bonus points from two frames prior
-            if (currentRound >= 2u && frames[currentRound - 2u].bonusRolls > 0) {
-                Frame& priorFrame = frames[currentRound - 2u];
-                priorFrame.currentScore += pinCount;
-                priorFrame.bonusRolls -= 1;
+            std::uint16_t changedFrames = 0u;
+            for (unsigned i = 0u; i < MaxFrames; i++) {
+                changedFrames |= static_cast<std::uint16_t>((frames[i] != amended.frames[i]) << i);
+            }
 
-                if (priorFrame.bonusRolls == 0) {
-                    // are there any additional frames to sum with the current score?
-                    if (currentRound >= 3u) { 
-                        priorFrame.totalScore = frames[currentRound - 3u].totalScore + priorFrame.currentScore;
+            amended.loggedRolls = amended.rollCount;
+            Publish(amended);
+
+            return { RollError::None, pinCount, changedFrames };
+        }
+
+        // retrieves how many rolls have been played
+        constexpr unsigned GetRollCount() const {
+            return rollCount;
+        }
+
+        // retrieves the pin count of a roll in the log, including undone rolls up to the last one that can be redone
+        constexpr unsigned GetLoggedRoll(unsigned rollIndex) const {
+            return static_cast<unsigned>(frames[rollIndex / LoggedRollsPerFrame].rollLog >> (rollIndex % LoggedRollsPerFrame * RollBits) & PackedFrame::RollMask);
+        }
+
+        // calls Roll() to knock over any remaining pins
+        constexpr std::optional<std::string> RollSpare() {
+            return TryRollSpare().ToMessage();
+        }
+
+        // calls Roll() to knock over all pins
+        constexpr std::optional<std::string> RollStrike() {
+            return TryRollStrike().ToMessage();
+        }
+
+        // allocation-free version of RollSpare()
+        constexpr RollResult TryRollSpare() {
+            if (IsGameComplete()) { // the round may be past the last frame
+                return { RollError::GameComplete, 0u };
+            }
+
+            PackedFrame const& frame = frames[currentRound];
+            if (!frame.HasFirstRoll()) {
+                return { RollError::InvalidSpare, 0u };
+            }
+
+            return TryRoll(NumPins - frame.GetPinsDown());
+        }
+
+        // allocation-free version of RollStrike()
+        constexpr RollResult TryRollStrike() {
+            return TryRoll(NumPins);
+        }
+
+        // replaces the game with the result of playing a whole roll sequence, equivalent to calling Roll() per ball
+        //-- validates the rolls into frames first, then scores every frame by looking ahead at its bonus rolls
+        //-- stops at the first rejected roll, keeping the rolls that came before it
+        constexpr RollResult ScoreRolls(std::span<const std::uint8_t> rolls) {
+            BasicGame next;
+            RollResult const result = next.LayOutRolls(rolls);
+            Publish(next);
+
+            return result;
+        }
+
+    private:
+        // the body of ScoreRolls(), replacing this game in place, for a game no other thread can see
+        constexpr RollResult LayOutRolls(std::span<const std::uint8_t> rolls) {
+            EXPERIS_NO_ALLOC_SCOPE();
+            Clear();
+
+            RollResult result;
+            std::array<size_t, FinalFrame> frameStarts{}; // index of the first roll in each frame
+            size_t acceptedRolls = 0u;
+
+            // lay out the rolls of the regular frames
+            for (; currentRound < FinalFrame && acceptedRolls < rolls.size(); currentRound++) {
+                PackedFrame& frame = frames[currentRound];
+                frameStarts[currentRound] = acceptedRolls;
+
+                bool isInProgress = false;
+                for (unsigned ball = 0u; ball < BallsPerFrame && frame.GetPinsDown() < NumPins; ball++) {
+                    if (acceptedRolls == rolls.size()) { // the frame is still in progress
+                        isInProgress = true;
+                        break;
                     }
-                    else { // no extra frames
-                        priorFrame.totalScore = priorFrame.currentScore;
+
+                    unsigned const pinCount = rolls[acceptedRolls];
+                    if (frame.GetPinsDown() + pinCount > NumPins) {
+                        result = { RollError::InvalidPinCount, pinCount };
+                        break;
                     }
+                    frame.SetRoll(ball, pinCount);
+                    acceptedRolls++;
+                }
+
+                if (isInProgress || result.error != RollError::None) {
+                    break;
                 }
             }
 
-            // compute bonus points from the previous frame
-            if (currentRound >= 1u && frames[currentRound - 1u].bonusRolls > 0) {
-                Frame& prevFrame = frames[currentRound - 1u];
-                prevFrame.currentScore += pinCount;
-                prevFrame.bonusRolls -= 1;
+            // lay out any bonus rolls earned in the final frame
+            int const earnedBonusRolls = static_cast<int>(frames[FinalFrame - 1u].GetEarnedBonusRolls());
+            for (int bonusRoll = 0; result.error == RollError::None && acceptedRolls < rolls.size(); bonusRoll++, acceptedRolls++) {
+                unsigned const pinCount = rolls[acceptedRolls];
+                if (bonusRoll >= earnedBonusRolls) {
+                    result = { RollError::GameComplete, pinCount };
+                    break;
+                }
+                if (pinCount > NumPins || !CheckRoll(pinCount, currentRound)) {
+                    result = { RollError::InvalidPinCount, pinCount };
+                    break;
+                }
 
-                if (prevFrame.bonusRolls == 0) {
-                    if (currentRound >= 2u) {
-                        prevFrame.totalScore = frames[currentRound - 2u].totalScore + prevFrame.currentScore;
+                frames[currentRound].SetRoll(0u, pinCount);
+                if (pinCount == NumPins) {
+                    frames[currentRound].bonusRolls = StrikeBonusRolls;
+                }
+
+                if (currentRound == FirstBonusFrame - 1u) {
+                    currentRound++;
+                }
+                else { // the second bonus roll also counts towards a strike in the first bonus frame
+                    if (frames[FirstBonusFrame - 1u].bonusRolls > 0u) {
+                        frames[FirstBonusFrame - 1u].currentScore += pinCount;
+                        frames[FirstBonusFrame - 1u].bonusRolls -= 1u;
                     }
-                    else {
-                        prevFrame.totalScore = prevFrame.currentScore;
+                    if (IsStrike(SecondBonusFrame - 1u) || (IsStrike(FinalFrame - 1u) && IsStrike(FirstBonusFrame - 1u))) {
+                        currentRound++;
                     }
                 }
             }
 
-            if (!frames[currentRound].pinsOnFirstRoll) { // we need to set the score for the first roll
-                frames[currentRound].pinsOnFirstRoll = pinCount;
+            // score the regular frames from their own rolls plus whichever bonus rolls have been played
+            unsigned runningTotal = 0u;
+            bool isResolved = true;
+            for (unsigned round = 0u; round < FinalFrame && frames[round].HasFirstRoll(); round++) {
+                PackedFrame& frame = frames[round];
+                bool const isClosed = frame.GetPinsDown() == NumPins || frame.GetBallCount() == BallsPerFrame;
+                unsigned const bonusRolls = frame.GetEarnedBonusRolls();
+
+                frame.currentScore = frame.GetPinsDown();
+                if (bonusRolls > 0u) {
+                    size_t const bonusStart = frameStarts[round] + frame.GetBallCount();
+                    size_t const playedBonusRolls = std::min<size_t>(bonusRolls, acceptedRolls - bonusStart);
+                    for (size_t i = 0u; i < playedBonusRolls; i++) {
+                        frame.currentScore += rolls[bonusStart + i];
+                    }
+                    frame.bonusRolls = bonusRolls - static_cast<unsigned>(playedBonusRolls);
+                }
+                provisionalScore += static_cast<std::uint16_t>(frame.currentScore);
+
+                // totals are only known once this frame and all before it have every roll they need
+                isResolved = isResolved && isClosed && frame.bonusRolls == 0u;
+                if (isResolved) {
+                    runningTotal += frame.currentScore;
+                    frame.totalScore = runningTotal;
+                }
+            }
+            finalizedScore = static_cast<std::uint16_t>(runningTotal);
+
+            for (size_t i = 0u; i < acceptedRolls; i++) {
+                SetLoggedRoll(static_cast<unsigned>(i), rolls[i]);
+            }
+            rollCount = static_cast<std::uint8_t>(acceptedRolls);
+            loggedRolls = rollCount;
+
+            return result;
+        }
+
+        // brackets a change to the game, keeping its version odd for as long as the change is in progress
+        class WriteScope {
+        private:
+            BasicGame& game;
+
+        public:
+            constexpr explicit WriteScope(BasicGame& changedGame)
+                : game(changedGame) {
+                if (!std::is_constant_evaluated()) {
+                    std::atomic_ref(game.version).store(game.version + 1u, std::memory_order_relaxed);
+                    std::atomic_thread_fence(std::memory_order_release);
+                }
+            }
+
+            constexpr ~WriteScope() {
+                if (!std::is_constant_evaluated()) {
+                    std::atomic_ref(game.version).store(game.version + 1u, std::memory_order_release);
+                }
+            }
+
+            WriteScope(WriteScope const&) = delete;
+            WriteScope& operator=(WriteScope const&) = delete;
+        };
+
+        // replaces the state of play with a changed copy of the game, leaving the version counting on
+        //-- every change is made on the copy first, then stored through atomic_ref inside a WriteScope,
+        //-- so a concurrent Snapshot() only ever races with atomic stores and retries if it overlapped them
+        //-- only the frames in the mask are stored, which keeps a single roll down to the few it touches
+        constexpr void Publish(BasicGame const& next, unsigned changedFrames = (1u << MaxFrames) - 1u) {
+            WriteScope const write(*this);
+            if (std::is_constant_evaluated()) {
+                finalizedScore = next.finalizedScore;
+                provisionalScore = next.provisionalScore;
+                currentRound = next.currentRound;
+                rollCount = next.rollCount;
+                loggedRolls = next.loggedRolls;
+                frames = next.frames;
+                return;
+            }
+
+            StoreShared(finalizedScore, next.finalizedScore);
+            StoreShared(provisionalScore, next.provisionalScore);
+            StoreShared(currentRound, next.currentRound);
+            StoreShared(rollCount, next.rollCount);
+            StoreShared(loggedRolls, next.loggedRolls);
+            for (unsigned mask = changedFrames; mask != 0u; mask &= mask - 1u) {
+                unsigned const i = static_cast<unsigned>(std::countr_zero(mask));
+                StoreShared(frames[i], next.frames[i]);
+            }
+        }
+
+        // swaps a value between host and little-endian byte order, which is the same operation both ways
+        template <class T>
+        static constexpr T ToLittleEndian(T value) {
+            if constexpr (std::endian::native == std::endian::little) {
+                return value;
+            }
+            else {
+                T swapped = 0u;
+                for (size_t i = 0u; i < sizeof(T); i++) {
+                    swapped = static_cast<T>(swapped << 8u | (value >> (8u * i) & 0xffu));
+                }
+
+                return swapped;
+            }
+        }
+
+        // the CRC-32C of every checkpoint field after the checksum, read as little-endian values
+        static constexpr std::uint32_t GetChecksum(Checkpoint const& checkpoint) {
+            Crc32c crc;
+            crc.Update(ToLittleEndian(checkpoint.finalizedScore)).Update(ToLittleEndian(checkpoint.provisionalScore));
+            crc.Update(checkpoint.currentRound).Update(checkpoint.rollCount).Update(checkpoint.loggedRolls).Update(checkpoint.reserved);
+            crc.Update(ToLittleEndian(checkpoint.reservedWord));
+            for (FrameWord const word : checkpoint.frames) {
+                crc.Update(ToLittleEndian(word));
+            }
+
+            return crc.Get();
+        }
+
+        // whether a checkpoint is intact, was saved under these rules, and holds a state this game can be in
+        //-- every check runs whatever the earlier ones found, so a rejection takes as long as an acceptance
+        static constexpr bool IsRestorable(Checkpoint const& checkpoint) {
+            bool isValid = checkpoint.magic == Checkpoint::Magic;
+            isValid &= checkpoint.formatVersion == Checkpoint::CurrentVersion;
+            isValid &= checkpoint.numFrames == FinalFrame && checkpoint.numPins == NumPins && checkpoint.ballsPerFrame == BallsPerFrame;
+            isValid &= ToLittleEndian(checkpoint.checksum) == GetChecksum(checkpoint);
+            isValid &= checkpoint.rollCount <= checkpoint.loggedRolls && checkpoint.loggedRolls <= MaxRolls;
+
+            // rolls and pending bonuses in range, so later rolls never index past the frames or count past the pins
+            unsigned pendingBonus = 0u;
+            for (size_t i = 0u; i < MaxFrames; i++) {
+                PackedFrame const frame = PackedFrame::FromWord(ToLittleEndian(checkpoint.frames[i]));
+                for (unsigned ball = 0u; ball < BallsPerFrame; ball++) {
+                    isValid &= (frame.GetRoll(ball) <= NumPins) | !frame.HasRoll(ball);
+                }
+                isValid &= frame.bonusRolls <= std::max(Rules::StrikeBonusRolls, Rules::SpareBonusRolls);
+                pendingBonus = i == FinalFrame - 1u ? static_cast<unsigned>(frame.bonusRolls) : pendingBonus;
+            }
+            isValid &= checkpoint.currentRound < MaxFrames || (checkpoint.currentRound == MaxFrames && pendingBonus == 0u);
+
+            return isValid;
+        }
+
+        // reads a member that a writer might be changing concurrently
+        template <class T>
+        static T LoadShared(T const& member, std::memory_order order) {
+            return std::atomic_ref(const_cast<T&>(member)).load(order);
+        }
+
+        // writes a member that a reader might be loading concurrently, see Publish()
+        template <class T>
+        static void StoreShared(T& member, T value) {
+            std::atomic_ref(member).store(value, std::memory_order_relaxed);
+        }
+
+        // validates a roll against the current state of play
+        constexpr RollResult CheckPlayable(unsigned pinCount) const {
+            if (IsGameComplete()) {
+                return { RollError::GameComplete, pinCount };
+            }
+            if (pinCount > NumPins || !CheckRoll(pinCount, currentRound)) {
+                return { RollError::InvalidPinCount, pinCount };
+            }
+
+            return {};
+        }
+
+        // scores a roll that has already been validated
+        constexpr void PlayRoll(unsigned pinCount) {
+            // add in points until the final frame
+            if (currentRound <= FinalFrame - 1u) {
+                frames[currentRound].currentScore += pinCount;
+                provisionalScore += static_cast<std::uint16_t>(pinCount);
+            }
+
+            ScoringEngine::ResolveBonuses(*this, pinCount);
+
+            if (currentRound >= FinalFrame) { // bonus rolls only ever take the first roll of their frame
+                frames[currentRound].SetRoll(0u, pinCount);
 
                 // did we get a strike? early out
                 if (IsStrike(currentRound)) {
                     frames[currentRound].bonusRolls = StrikeBonusRolls;
-                    frames[currentRound].isStrike = true;
                     currentRound++;
 
-                    return std::nullopt;
+                    return;
                 }
 
                 // was the last round a spare? early out
                 if (currentRound == FirstBonusFrame - 1u && IsSpare(FinalFrame - 1u)) {
                     currentRound++;
 
-                    return std::nullopt;
+                    return;
                 }
 
                 // did we get double strikes?
                 if (currentRound == SecondBonusFrame - 1u && IsStrike(FinalFrame - 1u) && IsStrike(FirstBonusFrame - 1u)) {
                     currentRound++;
                 }
+
+                return;
             }
-            else { // we are on the second roll
-                frames[currentRound].pinsOnSecondRoll = pinCount;
 
-                if (IsSpare(currentRound)) { // account for spare bonus rolls
-                    frames[currentRound].bonusRolls = SpareBonusRolls;
-                    frames[currentRound].isSpare = true;
+            PackedFrame& frame = frames[currentRound];
+            unsigned const ball = frame.GetBallCount();
+            frame.SetRoll(ball, pinCount);
+
+            if (unsigned const bonusRolls = frame.GetEarnedBonusRolls(); bonusRolls > 0u) { // account for strike and spare bonus rolls
+                frame.bonusRolls = bonusRolls;
+                currentRound++;
+            }
+            else if (frame.GetPinsDown() == NumPins || ball + 1u == BallsPerFrame) { // the frame is over, with nothing owed
+                // update the score
+                if (currentRound >= 1u) {
+                    frame.totalScore = frames[currentRound - 1u].totalScore + frame.currentScore;
                 }
-                else { // average roll
-                    // update the score
-                    if (currentRound >= 1u) {
-                        frames[currentRound].totalScore = frames[currentRound - 1u].totalScore + frames[currentRound].currentScore;
-                    }
-                    else {
-                        frames[currentRound].totalScore = frames[currentRound].currentScore;
-                    }
+                else {
+                    frame.totalScore = frame.currentScore;
                 }
+                finalizedScore = static_cast<std::uint16_t>(frame.totalScore);
 
                 currentRound++;
             }
+        }
 
-            return std::nullopt;
+        // a roll always changes the current frame, and otherwise only the two before it, if they're still owed bonus rolls
+        constexpr std::uint16_t GetFramesChangedByNextRoll() const {
+            unsigned changedFrames = 1u << currentRound;
+            if (currentRound >= 1u && frames[currentRound - 1u].bonusRolls > 0u) {
+                changedFrames |= 1u << (currentRound - 1u);
+            }
+            if (currentRound >= 2u && frames[currentRound - 2u].bonusRolls > 0u) {
+                changedFrames |= 1u << (currentRound - 2u);
+            }
+
+            return static_cast<std::uint16_t>(changedFrames);
         }
 
-        // calls Roll() to knock over any remaining pins
-        constexpr std::optional<std::string> RollSpare() {
-            Frame const& frame = frames[currentRound];
-            if (!frame.pinsOnFirstRoll) {
-                return "Invalid spare roll\n";
+        // stores a roll's pin count in the log, in the spare bits of the frames
+        constexpr void SetLoggedRoll(unsigned rollIndex, unsigned pinCount) {
+            PackedFrame& frame = frames[rollIndex / LoggedRollsPerFrame];
+            unsigned const shift = rollIndex % LoggedRollsPerFrame * RollBits;
+            frame.rollLog = (frame.rollLog & ~(PackedFrame::RollMask << shift)) | static_cast<FrameWord>(pinCount) << shift;
+        }
+
+        // plays the logged rolls from the current one up to, but not including, the end index
+        constexpr RollResult ReplayLog(unsigned end) {
+            for (; rollCount < end; rollCount++) {
+                unsigned const pinCount = GetLoggedRoll(rollCount);
+                if (RollResult const result = CheckPlayable(pinCount); !result) {
+                    return result;
+                }
+                PlayRoll(pinCount);
             }
 
-            return Roll(NumPins - frame.pinsOnFirstRoll.value());
+            return {};
         }
 
-        // calls Roll() to knock over all pins
-        constexpr std::optional<std::string> RollStrike() {
-            return Roll(NumPins);
+        // finds the frame a roll was played in, counting bonus rolls towards the final frame
+        constexpr unsigned FindRollFrame(unsigned rollIndex) const {
+            unsigned playedRolls = 0u;
+            for (unsigned round = 0u; round < FinalFrame - 1u; round++) {
+                playedRolls += frames[round].GetBallCount();
+                if (playedRolls > rollIndex) {
+                    return round;
+                }
+            }
+
+            return FinalFrame - 1u;
+        }
+
+        // takes the game back to the start of a regular frame, as if none of the rolls from there on had been played
+        //-- the log is kept, and only the two frames before can have been waiting on the rolls that are taken back
+        constexpr void Rewind(unsigned round) {
+            unsigned playedRolls = 0u;
+            for (unsigned i = 0u; i < round; i++) {
+                playedRolls += frames[i].GetBallCount();
+            }
+            for (unsigned i = round; i < MaxFrames; i++) {
+                frames[i] = PackedFrame{ .rollLog = frames[i].rollLog };
+            }
+
+            // put back the bonus rolls that strikes and spares right before the frame were still owed
+            //-- the frame two back is only still owed rolls if it earned more than the previous frame's own balls
+            if (round >= 1u && frames[round - 1u].GetEarnedBonusRolls() > 0u) {
+                PackedFrame& prevFrame = frames[round - 1u];
+                prevFrame.currentScore = NumPins;
+                prevFrame.bonusRolls = prevFrame.GetEarnedBonusRolls();
+                prevFrame.totalScore = 0u;
+            }
+            if (round >= 2u && frames[round - 2u].GetEarnedBonusRolls() > frames[round - 1u].GetBallCount()) {
+                PackedFrame& priorFrame = frames[round - 2u];
+                priorFrame.currentScore = NumPins + frames[round - 1u].GetPinsDown();
+                priorFrame.bonusRolls = priorFrame.GetEarnedBonusRolls() - frames[round - 1u].GetBallCount();
+                priorFrame.totalScore = 0u;
+            }
+
+            currentRound = static_cast<std::uint8_t>(round);
+            rollCount = static_cast<std::uint8_t>(playedRolls);
+            provisionalScore = 0u;
+            finalizedScore = 0u;
+            for (unsigned i = 0u; i < round; i++) {
+                provisionalScore += static_cast<std::uint16_t>(frames[i].currentScore);
+                if (frames[i].bonusRolls == 0u) {
+                    finalizedScore = static_cast<std::uint16_t>(frames[i].totalScore);
+                }
+            }
+        }
+
+        // puts every frame back to the start of a game, leaving the version alone
+        constexpr void Clear() {
+            finalizedScore = 0u;
+            provisionalScore = 0u;
+            currentRound = 0u;
+            rollCount = 0u;
+            loggedRolls = 0u;
+            frames.fill(PackedFrame());
         }
 
-    private:
         constexpr bool IsSpare(unsigned round) const {
-            return frames[round].pinsOnFirstRoll.value_or(0u) + frames[round].pinsOnSecondRoll.value_or(0u) == NumPins;
+            return frames[round].FirstRollOrZero() + frames[round].SecondRollOrZero() == NumPins;
         }
 
         constexpr bool IsStrike(unsigned round) const { 
-            return frames[round].pinsOnFirstRoll == NumPins; 
+            return frames[round].GetRoll(0u) == NumPins; 
         }
     };
+
+    // the ten-pin game with the default scoring engine
+    using Game = BasicGame<>;
+
+    // variants of the game, see GameRules.hpp
+    using CandlepinGame = BasicGame<CandlepinRules>;
+    using FivePinGame = BasicGame<FivePinRules>;
+
+    // the packed layout keeps a whole game within a single cache line
+    static_assert(sizeof(Game) <= 64u);
 } // namespace ExperisBowling
\ No newline at end of file
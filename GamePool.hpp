@@ -0,0 +1,146 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include "Game.hpp"
+#include <optional>
+
+namespace ExperisBowling {
+    // refers to a game in a GamePool, staying valid until that game is released
+    //-- the generation tells a released-and-reacquired slot apart from the game the handle was issued for
+    struct GameHandle {
+        std::uint32_t   index       = 0u;
+        std::uint32_t   generation  = 0u;
+
+        constexpr bool operator==(GameHandle const&) const = default;
+    };
+
+    // Fixed-capacity slab of games, with O(1) acquire, release and reset through a free list of slot indices.
+    //-- every game sits in its own cache line, so threads updating different games never share one
+    //-- acquiring and releasing isn't thread-safe - one thread owns the bookkeeping, while any thread may play a game it holds
+    template <size_t Capacity>
+    class GamePool {
+    public:
+        static constexpr size_t CacheLineSize = 64u;
+
+        static_assert(Capacity > 0u && Capacity < UINT32_MAX, "a pool's slots are indexed with 32 bits");
+        static_assert(sizeof(Game) + sizeof(std::uint32_t) <= CacheLineSize, "a game and its generation should fit in one cache line");
+
+    private:
+        static constexpr std::uint32_t NoSlot = UINT32_MAX;
+        static constexpr size_t MaskBits = 64u;
+        static constexpr size_t MaskWords = (Capacity + MaskBits - 1u) / MaskBits;
+
+        struct alignas(CacheLineSize) Slot {
+            Game            game;
+            std::uint32_t   generation  = 0u;
+        };
+
+        std::array<Slot, Capacity>                  slots           = {};
+        std::array<std::uint32_t, Capacity>         nextFree        = MakeFreeList();   // kept apart so game lines only hold game state
+        std::array<std::uint64_t, MaskWords>        activeMask      = {};   // one bit per acquired slot, for bulk iteration
+        std::uint32_t                               firstFree       = 0u;
+        std::uint32_t                               activeCount     = 0u;
+
+    public:
+        // claims a fresh game, or nothing if every slot is taken
+        constexpr std::optional<GameHandle> Acquire() {
+            if (firstFree == NoSlot) {
+                return std::nullopt;
+            }
+
+            std::uint32_t const index = firstFree;
+            Slot& slot = slots[index];
+            firstFree = nextFree[index];
+            activeMask[index / MaskBits] |= std::uint64_t{ 1u } << (index % MaskBits);
+            activeCount++;
+
+            return GameHandle{ index, slot.generation };
+        }
+
+        // returns a game's slot to the pool, invalidating every handle to it
+        constexpr bool Release(GameHandle handle) {
+            if (!IsValid(handle)) {
+                return false;
+            }
+
+            Slot& slot = slots[handle.index];
+            slot.game.Reset();
+            slot.generation++;
+            nextFree[handle.index] = firstFree;
+            firstFree = handle.index;
+            activeMask[handle.index / MaskBits] &= ~(std::uint64_t{ 1u } << (handle.index % MaskBits));
+            activeCount--;
+
+            return true;
+        }
+
+        // starts a game over without giving up its slot, so existing handles keep working
+        constexpr bool Reset(GameHandle handle) {
+            if (!IsValid(handle)) {
+                return false;
+            }
+
+            slots[handle.index].game.Reset();
+            return true;
+        }
+
+        // checks whether a handle still refers to the game it was issued for
+        constexpr bool IsValid(GameHandle handle) const {
+            return handle.index < Capacity && slots[handle.index].generation == handle.generation
+                && (activeMask[handle.index / MaskBits] >> (handle.index % MaskBits) & 1u) != 0u;
+        }
+
+        // retrieves the game behind a handle, or nullptr if the handle is stale
+        constexpr Game* Get(GameHandle handle) {
+            return IsValid(handle) ? &slots[handle.index].game : nullptr;
+        }
+
+        constexpr Game const* Get(GameHandle handle) const {
+            return IsValid(handle) ? &slots[handle.index].game : nullptr;
+        }
+
+        // retrieves how many games are currently acquired
+        constexpr size_t GetActiveCount() const {
+            return activeCount;
+        }
+
+        static constexpr size_t GetCapacity() {
+            return Capacity;
+        }
+
+        // calls body(handle, game) for every acquired game, in slot order
+        //-- walks the active mask a word at a time, so empty stretches of the slab are skipped without touching their games
+        template <class Body>
+        constexpr void ForEachActive(Body&& body) {
+            for (size_t word = 0u; word < MaskWords; word++) {
+                for (std::uint64_t bits = activeMask[word]; bits != 0u; bits &= bits - 1u) {
+                    std::uint32_t const index = static_cast<std::uint32_t>(word * MaskBits + static_cast<size_t>(std::countr_zero(bits)));
+                    body(GameHandle{ index, slots[index].generation }, slots[index].game);
+                }
+            }
+        }
+
+        template <class Body>
+        constexpr void ForEachActive(Body&& body) const {
+            for (size_t word = 0u; word < MaskWords; word++) {
+                for (std::uint64_t bits = activeMask[word]; bits != 0u; bits &= bits - 1u) {
+                    std::uint32_t const index = static_cast<std::uint32_t>(word * MaskBits + static_cast<size_t>(std::countr_zero(bits)));
+                    body(GameHandle{ index, slots[index].generation }, static_cast<Game const&>(slots[index].game));
+                }
+            }
+        }
+
+    private:
+        // chains every slot into the free list, lowest index first
+        static constexpr std::array<std::uint32_t, Capacity> MakeFreeList() {
+            std::array<std::uint32_t, Capacity> links{};
+            for (size_t i = 0u; i < Capacity; i++) {
+                links[i] = i + 1u < Capacity ? static_cast<std::uint32_t>(i + 1u) : NoSlot;
+            }
+
+            return links;
+        }
+    };
+} // namespace ExperisBowling
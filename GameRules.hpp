@@ -0,0 +1,46 @@
+#pragma once
+
+#include <concepts>
+
+namespace ExperisBowling {
+    // Rules policies describe a variant of the game for BasicGame.
+    //-- every value is a compile-time constant, so a game built on them costs the same as one with the numbers written in
+    //-- a frame ends once its pins are down or its balls run out; clearing the pins with the first ball earns
+    //-- StrikeBonusRolls, with the second ball earns SpareBonusRolls, and with any later ball earns nothing
+    //-- bonus rolls after the final frame are played into bonus frames, so neither bonus can exceed two rolls
+    template <class T>
+    concept GameRules = requires {
+        { T::NumPins } -> std::convertible_to<unsigned>;
+        { T::NumFrames } -> std::convertible_to<unsigned>;
+        { T::BallsPerFrame } -> std::convertible_to<unsigned>;
+        { T::StrikeBonusRolls } -> std::convertible_to<unsigned>;
+        { T::SpareBonusRolls } -> std::convertible_to<unsigned>;
+    } && T::NumPins > 0u && T::NumFrames > 0u && T::BallsPerFrame > 0u && T::StrikeBonusRolls <= 2u && T::SpareBonusRolls <= 2u;
+
+    // the standard game - ten pins, two balls per frame
+    struct TenPinRules {
+        static constexpr unsigned NumPins = 10u;
+        static constexpr unsigned NumFrames = 10u;
+        static constexpr unsigned BallsPerFrame = 2u;
+        static constexpr unsigned StrikeBonusRolls = 2u;
+        static constexpr unsigned SpareBonusRolls = 1u;
+    };
+
+    // ten thin pins and three balls per frame, where clearing the pins with the third ball scores no bonus
+    struct CandlepinRules {
+        static constexpr unsigned NumPins = 10u;
+        static constexpr unsigned NumFrames = 10u;
+        static constexpr unsigned BallsPerFrame = 3u;
+        static constexpr unsigned StrikeBonusRolls = 2u;
+        static constexpr unsigned SpareBonusRolls = 1u;
+    };
+
+    // five pins worth 15 points between them, so each roll reports the points it knocked down rather than a pin count
+    struct FivePinRules {
+        static constexpr unsigned NumPins = 15u;
+        static constexpr unsigned NumFrames = 10u;
+        static constexpr unsigned BallsPerFrame = 3u;
+        static constexpr unsigned StrikeBonusRolls = 2u;
+        static constexpr unsigned SpareBonusRolls = 1u;
+    };
+} // namespace ExperisBowling
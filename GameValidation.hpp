@@ -0,0 +1,269 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include "Game.hpp"
+#include "GameRules.hpp"
+#include <span>
+
+namespace ExperisBowling {
+    // Scores roll sequences the textbook way, sharing no code with BasicGame, so the two can check each other.
+    //-- walks the rolls frame by frame and adds each frame's bonus rolls straight from the sequence
+    template <GameRules Rules = TenPinRules>
+    struct ReferenceScorer {
+        static constexpr unsigned MaxScore = Rules::NumFrames * Rules::NumPins * (1u + std::max(Rules::StrikeBonusRolls, Rules::SpareBonusRolls));
+
+        // what the reference rules make of a roll sequence
+        struct Result {
+            bool        isValid         = true;     // false if a roll knocks down more pins than were standing, or comes after the last one
+            bool        isComplete      = false;
+            unsigned    standingPins    = 0u;       // the most the next roll can knock down, while the game is still going
+            unsigned    score           = 0u;       // the final score, once the game is complete
+        };
+
+        // the bonus rolls a frame earns by clearing the pins with the given number of balls
+        static constexpr unsigned GetBonusRolls(unsigned pinsDown, unsigned balls) {
+            if (pinsDown < Rules::NumPins) {
+                return 0u;
+            }
+
+            return balls == 1u ? Rules::StrikeBonusRolls : balls == 2u ? Rules::SpareBonusRolls : 0u;
+        }
+
+        static constexpr Result Evaluate(std::span<const std::uint8_t> rolls) {
+            size_t next = 0u;
+            unsigned score = 0u;
+            unsigned bonusRolls = 0u;
+            for (unsigned frame = 0u; frame < Rules::NumFrames; frame++) {
+                unsigned pinsDown = 0u;
+                unsigned balls = 0u;
+                for (; balls < Rules::BallsPerFrame && pinsDown < Rules::NumPins; balls++) {
+                    if (next == rolls.size()) {
+                        return { true, false, Rules::NumPins - pinsDown };
+                    }
+                    if (rolls[next] > Rules::NumPins - pinsDown) {
+                        return { false };
+                    }
+                    pinsDown += rolls[next++];
+                }
+
+                bonusRolls = GetBonusRolls(pinsDown, balls);
+                score += pinsDown;
+                for (size_t i = next; i < next + bonusRolls && i < rolls.size(); i++) {
+                    score += rolls[i];
+                }
+            }
+
+            // the final frame's bonus rolls get a fresh rack whenever one of them clears it
+            unsigned standingPins = Rules::NumPins;
+            for (unsigned bonusRoll = 0u; bonusRoll < bonusRolls; bonusRoll++) {
+                if (next == rolls.size()) {
+                    return { true, false, standingPins };
+                }
+                if (rolls[next] > standingPins) {
+                    return { false };
+                }
+                standingPins -= rolls[next++];
+                if (standingPins == 0u) {
+                    standingPins = Rules::NumPins;
+                }
+            }
+
+            if (next != rolls.size()) {
+                return { false };
+            }
+
+            return { true, true, 0u, score };
+        }
+    };
+
+    // how many distinct legal games end on each final score
+    //-- ten-pin has about 5.7 quintillion games in all, which still fit in 64 bits
+    template <GameRules Rules = TenPinRules>
+    using ScoreDistribution = std::array<std::uint64_t, ReferenceScorer<Rules>::MaxScore + 1u>;
+
+    // one way a frame can be played, counting the final frame's bonus rolls as part of it
+    template <GameRules Rules>
+    struct FrameOutcome {
+        std::array<unsigned, Rules::BallsPerFrame + 2u>     rolls       = {};
+        unsigned                                            rollCount   = 0u;
+        unsigned                                            balls       = 0u;       // rolls thrown at the frame's own rack
+        unsigned                                            bonusRolls  = 0u;       // bonus rolls the frame earned
+        bool                                                isOver      = false;    // whether the frame's own rack is done with
+    };
+
+    // calls body(outcome) for every way a frame can be played, in order of its pin counts
+    template <GameRules Rules, class Body>
+    constexpr void ForEachFrameOutcome(bool isFinal, Body& body, FrameOutcome<Rules> const& outcome = {}, unsigned standingPins = Rules::NumPins) {
+        if (outcome.isOver && outcome.rollCount == outcome.balls + (isFinal ? outcome.bonusRolls : 0u)) {
+            body(outcome);
+            return;
+        }
+
+        for (unsigned pinCount = 0u; pinCount <= standingPins; pinCount++) {
+            FrameOutcome<Rules> next = outcome;
+            next.rolls[next.rollCount++] = pinCount;
+
+            unsigned const leftStanding = standingPins - pinCount;
+            if (!outcome.isOver) {
+                next.balls++;
+                next.isOver = leftStanding == 0u || next.balls == Rules::BallsPerFrame;
+                next.bonusRolls = ReferenceScorer<Rules>::GetBonusRolls(Rules::NumPins - leftStanding, next.balls);
+            }
+
+            // bonus rolls start on a fresh rack, and get another whenever they clear it
+            bool const isFreshRack = leftStanding == 0u || (next.isOver && !outcome.isOver);
+            ForEachFrameOutcome<Rules>(isFinal, body, next, isFreshRack ? Rules::NumPins : leftStanding);
+        }
+    }
+
+    // Counts every legal game by its final score, without playing any of them.
+    //-- a roll is worth its pins once, plus once more for each earlier strike or spare still owed it; only the next
+    //-- two rolls can be owed, so all the frames before any point collapse into six states of what those two rolls owe
+    //-- the games counted start with the given number of gutter frames, matching a GameValidator walk from there
+    template <GameRules Rules = TenPinRules>
+    constexpr ScoreDistribution<Rules> CountGames(unsigned gutterFrames = 0u) {
+        constexpr unsigned NextRollStates = 3u;     // nothing, one or two earlier frames owed the next roll
+        constexpr unsigned LaterRollStates = 2u;    // nothing or one earlier frame owed the roll after it
+
+        using Counts = std::array<std::array<ScoreDistribution<Rules>, LaterRollStates>, NextRollStates>;
+        Counts counts{};
+        counts[0][0][0] = 1u;
+
+        ScoreDistribution<Rules> games{};
+        unsigned reachedScore = 0u; // the most any game can have scored so far, as no roll is worth more than three times its pins
+        for (unsigned frame = std::min(gutterFrames, Rules::NumFrames - 1u); frame < Rules::NumFrames; frame++) {
+            bool const isFinal = frame + 1u == Rules::NumFrames;
+            Counts nextCounts{};
+
+            auto const countOutcome = [&](FrameOutcome<Rules> const& outcome) {
+                unsigned laterPins = 0u;
+                for (unsigned i = 2u; i < outcome.rollCount; i++) {
+                    laterPins += outcome.rolls[i];
+                }
+
+                for (unsigned owedNext = 0u; owedNext < NextRollStates; owedNext++) {
+                    for (unsigned owedLater = 0u; owedLater < LaterRollStates; owedLater++) {
+                        unsigned const points = outcome.rolls[0] * (1u + owedNext) + outcome.rolls[1] * (1u + owedLater) + laterPins;
+
+                        // a strike lets the roll after next carry on to the next frame, on top of what this frame earned
+                        unsigned const nextOwed = (outcome.balls == 1u ? owedLater : 0u) + (outcome.bonusRolls >= 1u);
+                        unsigned const laterOwed = outcome.bonusRolls >= 2u;
+
+                        ScoreDistribution<Rules> const& from = counts[owedNext][owedLater];
+                        ScoreDistribution<Rules>& to = isFinal ? games : nextCounts[nextOwed][laterOwed];
+                        for (unsigned score = 0u; score <= reachedScore && score + points < from.size(); score++) {
+                            to[score + points] += from[score];
+                        }
+                    }
+                }
+            };
+            ForEachFrameOutcome<Rules>(isFinal, countOutcome);
+
+            counts = nextCounts;
+            reachedScore = std::min(reachedScore + NextRollStates * Rules::NumPins, ReferenceScorer<Rules>::MaxScore);
+        }
+
+        return games;
+    }
+
+    // what an exhaustive walk of games found
+    template <GameRules Rules>
+    struct ValidationReport {
+        std::uint64_t               games       = 0u;   // complete games reached
+        std::uint64_t               rolls       = 0u;   // rolls tried on the way, accepted or not
+        std::uint64_t               mismatches  = 0u;   // places the engine and the reference disagreed
+        ScoreDistribution<Rules>    scores      = {};   // complete games by the engine's final score
+    };
+
+    // Plays every legal roll sequence that continues a prefix, one roll at a time, checking the engine against ReferenceScorer.
+    //-- after every roll, each pin count up to one past the full rack is tried, so the engine has to accept exactly the
+    //-- rolls the reference does and agree on when the game is over; FromRolls() has to turn away the first illegal one
+    //-- every complete game has to score the same as the reference and as FromRolls(), and take no more rolls of any kind
+    //-- every game along the way has to know the lowest and highest final scores the walk went on to reach from it
+    //-- whole games have far too many sequences to walk, so callers pick a prefix that leaves a few frames to go
+    template <class PlayedGame>
+    class GameValidator {
+    public:
+        using Rules = typename PlayedGame::RulesPolicy;
+        using Reference = ReferenceScorer<Rules>;
+        using Report = ValidationReport<Rules>;
+
+        static constexpr Report Walk(std::span<const std::uint8_t> prefix) {
+            Report report;
+            std::array<std::uint8_t, PlayedGame::MaxRolls> rolls{};
+            PlayedGame game{}; // braces matter, GCC 12 loses the frames' default bits here once Walk() has been constant-evaluated
+            if (prefix.size() > rolls.size()) {
+                report.mismatches++;
+                return report;
+            }
+
+            for (size_t i = 0u; i < prefix.size(); i++) {
+                rolls[i] = prefix[i];
+                if (!game.TryRoll(prefix[i])) {
+                    report.mismatches++;
+                    return report;
+                }
+            }
+
+            Visit(game, rolls, prefix.size(), report);
+            return report;
+        }
+
+    private:
+        // the lowest and highest final scores reachable from a game
+        struct ScoreRange {
+            unsigned    min     = 0u;
+            unsigned    max     = 0u;
+        };
+
+        // walks the games continuing from this one, returning the range of final scores they reached
+        static constexpr ScoreRange Visit(PlayedGame const& game, std::array<std::uint8_t, PlayedGame::MaxRolls>& rolls, size_t rollCount, Report& report) {
+            std::span<const std::uint8_t> const played(rolls.data(), rollCount);
+            typename Reference::Result const expected = Reference::Evaluate(played);
+            ScoreRange const claimed = { game.GetMinPossibleScore(), game.GetMaxPossibleScore() };
+            if (!expected.isValid || game.IsGameComplete() != expected.isComplete) {
+                report.mismatches++;
+                return claimed;
+            }
+
+            if (expected.isComplete) {
+                PlayedGame extra = game;
+                bool const isMatch = game.GetScore() == expected.score && game.GetProvisionalScore() == expected.score
+                    && PlayedGame::FromRolls(played) == game && extra.TryRoll(0u).error == RollError::GameComplete
+                    && extra.TryRollSpare().error == RollError::GameComplete && extra.TryRollStrike().error == RollError::GameComplete
+                    && claimed.min == expected.score && claimed.max == expected.score;
+
+                report.games++;
+                report.mismatches += !isMatch;
+                report.scores[std::min(game.GetScore(), Reference::MaxScore)]++;
+                return claimed;
+            }
+
+            ScoreRange reached = { Reference::MaxScore, 0u };
+
+            for (unsigned pinCount = 0u; pinCount <= Rules::NumPins + 1u; pinCount++) {
+                PlayedGame next = game;
+                bool const isAccepted = static_cast<bool>(next.TryRoll(pinCount));
+                bool const isLegal = pinCount <= expected.standingPins;
+                report.rolls++;
+
+                rolls[rollCount] = static_cast<std::uint8_t>(pinCount);
+                if (isAccepted != isLegal) {
+                    report.mismatches++;
+                }
+                else if (isLegal) {
+                    ScoreRange const range = Visit(next, rolls, rollCount + 1u, report);
+                    reached = { std::min(reached.min, range.min), std::max(reached.max, range.max) };
+                }
+                else if (pinCount == expected.standingPins + 1u && pinCount <= Rules::NumPins && PlayedGame::FromRolls({ rolls.data(), rollCount + 1u })) {
+                    report.mismatches++;
+                }
+            }
+
+            report.mismatches += reached.min != claimed.min || reached.max != claimed.max;
+            return reached;
+        }
+    };
+} // namespace ExperisBowling
@@ -0,0 +1,366 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <mutex>
+#include <ostream>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Build options for hot-path instrumentation:
+//-- EXPERIS_INSTRUMENT times rolls, score queries and scoreboard rendering with the CPU's timestamp counter, into
+//-- per-thread latency histograms, and counts valid, invalid, strike and spare rolls
+//-- without it the probe macros expand to nothing, so the hot paths compile exactly as if they weren't there
+namespace ExperisBowling {
+    // the code paths that can be timed
+    enum class Probe : std::uint8_t {
+        Roll,
+        IsGameComplete,
+        GetScore,
+        Render,
+        Count,
+    };
+
+    // the events that can be counted
+    enum class HotCounter : std::uint8_t {
+        ValidRoll,
+        InvalidRoll,
+        Strike,
+        Spare,
+        Count,
+    };
+
+    inline constexpr std::array<char const*, static_cast<size_t>(Probe::Count)> ProbeNames = { "Roll", "IsGameComplete", "GetScore", "Render" };
+    inline constexpr std::array<char const*, static_cast<size_t>(HotCounter::Count)> HotCounterNames = { "valid rolls", "invalid rolls", "strikes", "spares" };
+
+    // reads the cheapest monotonic tick counter the CPU offers, falling back to the steady clock in nanoseconds
+    inline std::uint64_t ReadTimestamp() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86)) || defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#elif defined(__aarch64__)
+        std::uint64_t ticks;
+        asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+        return ticks;
+#else
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    // a counter one thread bumps while others may read it, without the cost of an atomic add
+    inline void IncrementCounter(std::uint64_t& counter) {
+        std::atomic_ref<std::uint64_t> const shared(counter);
+        shared.store(shared.load(std::memory_order_relaxed) + 1u, std::memory_order_relaxed);
+    }
+
+    inline std::uint64_t LoadCounter(std::uint64_t const& counter) {
+        return std::atomic_ref(const_cast<std::uint64_t&>(counter)).load(std::memory_order_relaxed);
+    }
+
+    // Counts latencies into buckets that stay within an eighth of the value they hold, in the style of an HDR histogram.
+    //-- values below 8 get a bucket each, and every power of two above is split into 8 equal buckets, up to 2^32 ticks
+    //-- its owning thread records while any other thread may read, so every bucket is accessed atomically
+    class LatencyHistogram {
+    public:
+        static constexpr unsigned SubBucketBits = 3u;
+        static constexpr unsigned SubBuckets = 1u << SubBucketBits;
+        static constexpr unsigned BucketCount = (32u - SubBucketBits + 1u) * SubBuckets;
+
+    private:
+        alignas(std::atomic_ref<std::uint64_t>::required_alignment) std::array<std::uint64_t, BucketCount> counts = {};
+
+    public:
+        static constexpr unsigned GetBucket(std::uint64_t ticks) {
+            std::uint64_t const value = std::min<std::uint64_t>(ticks, UINT32_MAX);
+            unsigned const magnitude = static_cast<unsigned>(std::bit_width(value));
+            if (magnitude <= SubBucketBits) {
+                return static_cast<unsigned>(value);
+            }
+
+            // keep the leading bit and the three after it
+            unsigned const shift = magnitude - SubBucketBits - 1u;
+            return (shift + 1u) * SubBuckets + static_cast<unsigned>(value >> shift & (SubBuckets - 1u));
+        }
+
+        // the largest value a bucket holds
+        static constexpr std::uint64_t GetUpperBound(unsigned bucket) {
+            if (bucket + 1u >= BucketCount) {
+                return UINT32_MAX;
+            }
+
+            unsigned const next = bucket + 1u;
+            if (next < SubBuckets) {
+                return bucket;
+            }
+
+            return (static_cast<std::uint64_t>(SubBuckets + next % SubBuckets) << (next / SubBuckets - 1u)) - 1u;
+        }
+
+        constexpr void Record(std::uint64_t ticks) {
+            std::uint64_t& count = counts[GetBucket(ticks)];
+            if (std::is_constant_evaluated()) {
+                count++;
+            }
+            else {
+                IncrementCounter(count);
+            }
+        }
+
+        // adds another histogram's counts, which may still be recording on another thread
+        constexpr void Merge(LatencyHistogram const& other) {
+            for (unsigned i = 0u; i < BucketCount; i++) {
+                counts[i] += std::is_constant_evaluated() ? other.counts[i] : LoadCounter(other.counts[i]);
+            }
+        }
+
+        constexpr std::uint64_t GetCount() const {
+            std::uint64_t total = 0u;
+            for (std::uint64_t const count : counts) {
+                total += count;
+            }
+
+            return total;
+        }
+
+        // the value the given fraction of samples are at or below, to the histogram's precision
+        constexpr std::uint64_t GetPercentile(double fraction) const {
+            std::uint64_t const total = GetCount();
+            std::uint64_t const rank = std::max<std::uint64_t>(1u, static_cast<std::uint64_t>(fraction * static_cast<double>(total) + 0.5));
+
+            std::uint64_t seen = 0u;
+            for (unsigned i = 0u; i < BucketCount; i++) {
+                seen += counts[i];
+                if (seen >= rank) {
+                    return GetUpperBound(i);
+                }
+            }
+
+            return 0u;
+        }
+    };
+
+    // everything one thread has measured
+    struct ThreadMetrics {
+        static constexpr size_t MaxLanes = 64u; // lanes past this are still timed, just not broken out
+
+        std::array<LatencyHistogram, static_cast<size_t>(Probe::Count)>     probes      = {};
+        std::array<LatencyHistogram, MaxLanes>                              lanes       = {};   // Roll probes by the lane being played
+        alignas(std::atomic_ref<std::uint64_t>::required_alignment) std::array<std::uint64_t, static_cast<size_t>(HotCounter::Count)> counters = {};
+
+        void Merge(ThreadMetrics const& other) {
+            for (size_t i = 0u; i < probes.size(); i++) {
+                probes[i].Merge(other.probes[i]);
+            }
+            for (size_t i = 0u; i < lanes.size(); i++) {
+                lanes[i].Merge(other.lanes[i]);
+            }
+            for (size_t i = 0u; i < counters.size(); i++) {
+                counters[i] += LoadCounter(other.counters[i]);
+            }
+        }
+    };
+
+    // Collects the per-thread metrics, which each thread creates the first time it records anything.
+    //-- threads only ever write their own metrics, without locking; the lock just guards the list of them
+    //-- a thread's metrics are folded into a retired total when it exits, so nothing it measured is lost
+    class Metrics {
+    private:
+        struct Registration {
+            ThreadMetrics   metrics;
+            Registration*   prev    = nullptr;
+            Registration*   next    = nullptr;
+
+            Registration() {
+                std::lock_guard const lock(GetMutex());
+                next = GetHead();
+                if (next != nullptr) {
+                    next->prev = this;
+                }
+                GetHead() = this;
+            }
+
+            ~Registration() {
+                std::lock_guard const lock(GetMutex());
+                GetRetired().Merge(metrics);
+                (prev != nullptr ? prev->next : GetHead()) = next;
+                if (next != nullptr) {
+                    next->prev = prev;
+                }
+            }
+
+            Registration(Registration const&) = delete;
+            Registration& operator=(Registration const&) = delete;
+        };
+
+        static inline thread_local size_t currentLane = ThreadMetrics::MaxLanes;
+
+        static std::mutex& GetMutex() {
+            static std::mutex mutex;
+            return mutex;
+        }
+
+        static Registration*& GetHead() {
+            static Registration* head = nullptr;
+            return head;
+        }
+
+        static ThreadMetrics& GetRetired() {
+            static ThreadMetrics retired;
+            return retired;
+        }
+
+    public:
+        static constexpr bool IsEnabled() {
+#if defined(EXPERIS_INSTRUMENT)
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        // the calling thread's metrics
+        static ThreadMetrics& GetLocal() {
+            static thread_local Registration registration;
+            return registration.metrics;
+        }
+
+        static void Count(HotCounter counter) {
+            IncrementCounter(GetLocal().counters[static_cast<size_t>(counter)]);
+        }
+
+        static void Record(Probe probe, std::uint64_t ticks) {
+            ThreadMetrics& local = GetLocal();
+            local.probes[static_cast<size_t>(probe)].Record(ticks);
+            if (probe == Probe::Roll && currentLane < ThreadMetrics::MaxLanes) {
+                local.lanes[currentLane].Record(ticks);
+            }
+        }
+
+        // sets the lane the calling thread's rolls are attributed to, returning the one it replaces
+        static size_t SetLane(size_t lane) {
+            return std::exchange(currentLane, std::min(lane, ThreadMetrics::MaxLanes));
+        }
+
+        // merges every thread's metrics so far, including threads that have exited
+        static ThreadMetrics Collect() {
+            ThreadMetrics total;
+            std::lock_guard const lock(GetMutex());
+            total.Merge(GetRetired());
+            for (Registration const* registration = GetHead(); registration != nullptr; registration = registration->next) {
+                total.Merge(registration->metrics);
+            }
+
+            return total;
+        }
+
+        // how many timestamp ticks pass per nanosecond, measured against the steady clock over a few milliseconds
+        static double MeasureTicksPerNanosecond() {
+            using Clock = std::chrono::steady_clock;
+            Clock::time_point const start = Clock::now();
+            std::uint64_t const startTicks = ReadTimestamp();
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            std::uint64_t const ticks = ReadTimestamp() - startTicks;
+            double const nanoseconds = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+
+            return nanoseconds > 0.0 ? static_cast<double>(ticks) / nanoseconds : 1.0;
+        }
+
+        // writes the counters and the p50/p99/p999 of every probe and lane that recorded anything
+        static void Dump(std::ostream& out) {
+            ThreadMetrics const total = Collect();
+            double const ticksPerNanosecond = MeasureTicksPerNanosecond();
+
+            for (size_t i = 0u; i < total.counters.size(); i++) {
+                out << std::format("{:<24}{:>14}\n", HotCounterNames[i], total.counters[i]);
+            }
+
+            out << std::format("{:<24}{:>14}{:>12}{:>12}{:>12}\n", "latency (ns)", "samples", "p50", "p99", "p999");
+            auto const writeLatencies = [&](std::string_view name, LatencyHistogram const& histogram) {
+                if (std::uint64_t const count = histogram.GetCount(); count != 0u) {
+                    out << std::format("{:<24}{:>14}{:>12.0f}{:>12.0f}{:>12.0f}\n", name, count,
+                        static_cast<double>(histogram.GetPercentile(0.5)) / ticksPerNanosecond,
+                        static_cast<double>(histogram.GetPercentile(0.99)) / ticksPerNanosecond,
+                        static_cast<double>(histogram.GetPercentile(0.999)) / ticksPerNanosecond);
+                }
+            };
+            for (size_t i = 0u; i < total.probes.size(); i++) {
+                writeLatencies(ProbeNames[i], total.probes[i]);
+            }
+            for (size_t lane = 0u; lane < total.lanes.size(); lane++) {
+                writeLatencies(std::format("Roll on lane {}", lane), total.lanes[lane]);
+            }
+        }
+    };
+
+    // Times the scope it lives in into a probe's histogram.
+    //-- does nothing during constant evaluation, so it can sit in constexpr code
+    class ProbeTimer {
+    private:
+        std::uint64_t   start   = 0u;
+        Probe           probe;
+
+    public:
+        constexpr explicit ProbeTimer(Probe timedProbe)
+            : probe(timedProbe) {
+            if (!std::is_constant_evaluated()) {
+                start = ReadTimestamp();
+            }
+        }
+
+        constexpr ~ProbeTimer() {
+            if (!std::is_constant_evaluated()) {
+                Metrics::Record(probe, ReadTimestamp() - start);
+            }
+        }
+
+        ProbeTimer(ProbeTimer const&) = delete;
+        ProbeTimer& operator=(ProbeTimer const&) = delete;
+    };
+
+    // Attributes the rolls timed in its scope to a lane.
+    class LaneProbeScope {
+    private:
+        size_t  previousLane    = ThreadMetrics::MaxLanes;
+
+    public:
+        constexpr explicit LaneProbeScope(size_t lane) {
+            if (!std::is_constant_evaluated()) {
+                previousLane = Metrics::SetLane(lane);
+            }
+        }
+
+        constexpr ~LaneProbeScope() {
+            if (!std::is_constant_evaluated()) {
+                Metrics::SetLane(previousLane);
+            }
+        }
+
+        LaneProbeScope(LaneProbeScope const&) = delete;
+        LaneProbeScope& operator=(LaneProbeScope const&) = delete;
+    };
+} // namespace ExperisBowling
+
+// times the enclosing block, attributes its rolls to a lane, or counts an event - all compiled out unless instrumenting
+#if defined(EXPERIS_INSTRUMENT)
+#define EXPERIS_PROBE(probe) ::ExperisBowling::ProbeTimer const experisProbeTimer(::ExperisBowling::Probe::probe)
+#define EXPERIS_PROBE_LANE(lane) ::ExperisBowling::LaneProbeScope const experisLaneProbeScope(lane)
+#define EXPERIS_COUNT_IF(counter, condition) \
+    ((condition) && !std::is_constant_evaluated() ? ::ExperisBowling::Metrics::Count(::ExperisBowling::HotCounter::counter) : static_cast<void>(0))
+#else
+#define EXPERIS_PROBE(probe) static_cast<void>(0)
+#define EXPERIS_PROBE_LANE(lane) static_cast<void>(0)
+#define EXPERIS_COUNT_IF(counter, condition) static_cast<void>(0)
+#endif
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "Game.hpp"
+#include "GamePool.hpp"
+#include <optional>
+
+namespace ExperisBowling {
+    // Tracks the bowlers on every lane of a center, with all of their games kept in one shared pool.
+    //-- like the pool, adding and removing bowlers belongs to one thread, while lanes can be played from any
+    template <size_t LaneCount = 48u, size_t MaxBowlersPerLane = 6u>
+    class LaneManager {
+    public:
+        static constexpr size_t Lanes = LaneCount;
+        static constexpr size_t MaxBowlers = MaxBowlersPerLane;
+
+        using Pool = GamePool<LaneCount * MaxBowlersPerLane>;
+
+    private:
+        // the bowlers currently on a lane, in the order they bowl
+        struct Lane {
+            std::array<GameHandle, MaxBowlersPerLane>   bowlers         = {};
+            std::uint8_t                                bowlerCount     = 0u;
+        };
+
+        Pool                            pool;
+        std::array<Lane, LaneCount>     lanes   = {};
+
+    public:
+        // adds a bowler to the end of a lane's order, or nothing if the lane is full
+        constexpr std::optional<GameHandle> AddBowler(size_t lane) {
+            if (lane >= LaneCount || lanes[lane].bowlerCount == MaxBowlersPerLane) {
+                return std::nullopt;
+            }
+
+            // every lane can be full at once, so the pool always has a slot for a lane that isn't
+            GameHandle const handle = *pool.Acquire();
+            lanes[lane].bowlers[lanes[lane].bowlerCount++] = handle;
+
+            return handle;
+        }
+
+        // removes a bowler from a lane, moving the bowlers after them up one place
+        constexpr bool RemoveBowler(size_t lane, size_t bowler) {
+            if (lane >= LaneCount || bowler >= lanes[lane].bowlerCount) {
+                return false;
+            }
+
+            Lane& info = lanes[lane];
+            pool.Release(info.bowlers[bowler]);
+            for (size_t i = bowler + 1u; i < info.bowlerCount; i++) {
+                info.bowlers[i - 1u] = info.bowlers[i];
+            }
+            info.bowlerCount--;
+
+            return true;
+        }
+
+        // starts every game on a lane over, keeping its bowlers
+        constexpr void ResetLane(size_t lane) {
+            for (size_t i = 0u; lane < LaneCount && i < lanes[lane].bowlerCount; i++) {
+                pool.Reset(lanes[lane].bowlers[i]);
+            }
+        }
+
+        // releases every game on a lane
+        constexpr void ClearLane(size_t lane) {
+            for (size_t i = 0u; lane < LaneCount && i < lanes[lane].bowlerCount; i++) {
+                pool.Release(lanes[lane].bowlers[i]);
+            }
+            if (lane < LaneCount) {
+                lanes[lane].bowlerCount = 0u;
+            }
+        }
+
+        // retrieves how many bowlers are on a lane
+        constexpr size_t GetBowlerCount(size_t lane) const {
+            return lane < LaneCount ? lanes[lane].bowlerCount : 0u;
+        }
+
+        // retrieves the pool handle of a bowler's game, e.g. to journal rolls against it
+        constexpr std::optional<GameHandle> GetHandle(size_t lane, size_t bowler) const {
+            return bowler < GetBowlerCount(lane) ? std::optional(lanes[lane].bowlers[bowler]) : std::nullopt;
+        }
+
+        // retrieves a bowler's game, or nullptr if there's no such bowler
+        constexpr Game* GetGame(size_t lane, size_t bowler) {
+            return bowler < GetBowlerCount(lane) ? pool.Get(lanes[lane].bowlers[bowler]) : nullptr;
+        }
+
+        constexpr Game const* GetGame(size_t lane, size_t bowler) const {
+            return bowler < GetBowlerCount(lane) ? pool.Get(lanes[lane].bowlers[bowler]) : nullptr;
+        }
+
+        // the pool behind the lanes, for bulk work such as refreshing every scoreboard
+        constexpr Pool& GetPool() {
+            return pool;
+        }
+
+        constexpr Pool const& GetPool() const {
+            return pool;
+        }
+    };
+} // namespace ExperisBowling
@@ -0,0 +1,405 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include "Game.hpp"
+#include <optional>
+#include "ScoringProtocol.hpp"
+#include <span>
+#include <vector>
+
+namespace ExperisBowling {
+    // one bowler's line on the leaderboard, as it's replicated between nodes
+    //-- bowlers are addressed by center, lane and their place in the lane's order, like the controllers address them
+    struct LeaderboardUpdate {
+        static constexpr size_t Size = 12u;
+
+        std::uint16_t   center              = 0u;
+        std::uint8_t    lane                = 0u;
+        std::uint8_t    bowler              = 0u;
+        std::uint8_t    round               = 0u;
+        bool            isRemoved           = false;    // the bowler left the lane, and with them their line
+        std::uint16_t   score               = 0u;
+        std::uint16_t   provisionalScore    = 0u;
+        std::uint16_t   maxPossibleScore    = 0u;
+
+        // byte offsets of each field
+        static constexpr size_t CenterOffset = 0u;
+        static constexpr size_t LaneOffset = 2u;
+        static constexpr size_t BowlerOffset = 3u;
+        static constexpr size_t RoundOffset = 4u;
+        static constexpr size_t RemovedOffset = 5u;
+        static constexpr size_t ScoreOffset = 6u;
+        static constexpr size_t ProvisionalScoreOffset = 8u;
+        static constexpr size_t MaxPossibleScoreOffset = 10u;
+
+        // orders bowlers by center, then lane, then place on the lane
+        static constexpr std::uint32_t MakeKey(std::uint16_t center, std::uint8_t lane, std::uint8_t bowler) {
+            return std::uint32_t{ center } << 16u | std::uint32_t{ lane } << 8u | bowler;
+        }
+
+        constexpr std::uint32_t GetKey() const {
+            return MakeKey(center, lane, bowler);
+        }
+
+        constexpr void Encode(std::uint8_t* bytes) const {
+            ScoringHeader::StoreLittleEndian(bytes + CenterOffset, center);
+            bytes[LaneOffset] = lane;
+            bytes[BowlerOffset] = bowler;
+            bytes[RoundOffset] = round;
+            bytes[RemovedOffset] = static_cast<std::uint8_t>(isRemoved);
+            ScoringHeader::StoreLittleEndian(bytes + ScoreOffset, score);
+            ScoringHeader::StoreLittleEndian(bytes + ProvisionalScoreOffset, provisionalScore);
+            ScoringHeader::StoreLittleEndian(bytes + MaxPossibleScoreOffset, maxPossibleScore);
+        }
+
+        static constexpr LeaderboardUpdate Decode(std::uint8_t const* bytes) {
+            LeaderboardUpdate update;
+            update.center = ScoringHeader::LoadLittleEndian<std::uint16_t>(bytes + CenterOffset);
+            update.lane = bytes[LaneOffset];
+            update.bowler = bytes[BowlerOffset];
+            update.round = bytes[RoundOffset];
+            update.isRemoved = bytes[RemovedOffset] != 0u;
+            update.score = ScoringHeader::LoadLittleEndian<std::uint16_t>(bytes + ScoreOffset);
+            update.provisionalScore = ScoringHeader::LoadLittleEndian<std::uint16_t>(bytes + ProvisionalScoreOffset);
+            update.maxPossibleScore = ScoringHeader::LoadLittleEndian<std::uint16_t>(bytes + MaxPossibleScoreOffset);
+
+            return update;
+        }
+    };
+
+    // Layout of a replication message, little-endian throughout:
+    //   header  - LeaderboardHeader::Size bytes: magic, version, flags, the publishing node and its message sequence number
+    //   updates - LeaderboardUpdate::Size bytes each
+    // a snapshot carries every line the node has, anything else only the lines that changed since the node's last message
+    struct LeaderboardHeader {
+        static constexpr std::array<std::uint8_t, 4u>   Magic           = { 'E', 'B', 'L', 'B' };
+        static constexpr std::uint8_t                   CurrentVersion  = 1u;
+        static constexpr size_t                         Size            = 16u;
+        static constexpr std::uint8_t                   SnapshotFlag    = 1u;
+
+        std::uint8_t    version         = CurrentVersion;
+        bool            isSnapshot      = false;
+        std::uint16_t   node            = 0u;
+        std::uint32_t   sequence        = 0u;
+        std::uint32_t   updateCount     = 0u;
+
+        // byte offsets of each field
+        static constexpr size_t VersionOffset = 4u;
+        static constexpr size_t FlagsOffset = 5u;
+        static constexpr size_t NodeOffset = 6u;
+        static constexpr size_t SequenceOffset = 8u;
+        static constexpr size_t UpdateCountOffset = 12u;
+
+        constexpr void Encode(std::uint8_t* bytes) const {
+            std::copy(Magic.begin(), Magic.end(), bytes);
+            bytes[VersionOffset] = version;
+            bytes[FlagsOffset] = isSnapshot ? SnapshotFlag : 0u;
+            ScoringHeader::StoreLittleEndian(bytes + NodeOffset, node);
+            ScoringHeader::StoreLittleEndian(bytes + SequenceOffset, sequence);
+            ScoringHeader::StoreLittleEndian(bytes + UpdateCountOffset, updateCount);
+        }
+
+        // reads a header, returning nothing if it isn't one we understand or the message is too short for its updates
+        static constexpr std::optional<LeaderboardHeader> Decode(std::span<const std::uint8_t> bytes) {
+            if (bytes.size() < Size || !std::equal(Magic.begin(), Magic.end(), bytes.begin()) || bytes[VersionOffset] != CurrentVersion) {
+                return std::nullopt;
+            }
+
+            LeaderboardHeader header;
+            header.isSnapshot = (bytes[FlagsOffset] & SnapshotFlag) != 0u;
+            header.node = ScoringHeader::LoadLittleEndian<std::uint16_t>(bytes.data() + NodeOffset);
+            header.sequence = ScoringHeader::LoadLittleEndian<std::uint32_t>(bytes.data() + SequenceOffset);
+            header.updateCount = ScoringHeader::LoadLittleEndian<std::uint32_t>(bytes.data() + UpdateCountOffset);
+            if ((bytes.size() - Size) / LeaderboardUpdate::Size < header.updateCount) {
+                return std::nullopt;
+            }
+
+            return header;
+        }
+    };
+
+    // Keeps the leaderboard lines of the games one node scores, and publishes what changed as replication messages.
+    //-- it follows the score deltas the scoring service already answers every command with, so it never reads a game
+    //-- however many rolls a bowler makes between two messages, the next message carries their line once
+    //-- it isn't thread-safe - whoever hands it the service's deltas also publishes
+    class LeaderboardPublisher {
+    private:
+        struct Line {
+            LeaderboardUpdate   update;
+            bool                isDirty     = false;
+        };
+
+        std::uint16_t                   node;
+        std::uint32_t                   sequence    = 0u;
+        std::vector<Line>               lines;      // ordered by key, so every lane's bowlers sit next to each other
+        std::vector<std::uint32_t>      dirtyKeys;
+
+    public:
+        constexpr explicit LeaderboardPublisher(std::uint16_t publishingNode)
+            : node(publishingNode) {
+        }
+
+        // follows one command a center's controller sent, with the delta the service answered it with
+        constexpr void Observe(std::uint16_t center, LaneCommand const& command, ScoreDelta const& delta) {
+            if (delta.status != CommandStatus::Applied) {
+                return;
+            }
+
+            switch (command.kind) {
+            case LaneCommandKind::Roll:
+            case LaneCommandKind::AddBowler: {
+                Line& line = Upsert(LeaderboardUpdate::MakeKey(center, delta.lane, delta.bowler));
+                line.update.round = delta.round;
+                line.update.score = delta.score;
+                line.update.provisionalScore = delta.provisionalScore;
+                line.update.maxPossibleScore = delta.maxPossibleScore;
+                MarkDirty(line);
+                break;
+            }
+
+            case LaneCommandKind::RemoveBowler: {
+                // the bowlers after the removed one move up a place, which leaves the lane's last place empty
+                //-- a place whose next bowler has never been seen is emptied too, until a delta for it comes in
+                std::span<Line> const lane = GetLiveLane(center, command.lane);
+                for (size_t i = 0u; i < lane.size(); i++) {
+                    std::uint8_t const place = lane[i].update.bowler;
+                    if (place < command.bowler) {
+                        continue;
+                    }
+
+                    if (i + 1u < lane.size() && lane[i + 1u].update.bowler == place + 1u) {
+                        lane[i].update = lane[i + 1u].update;
+                        lane[i].update.bowler = place;
+                    }
+                    else {
+                        lane[i].update.isRemoved = true;
+                    }
+                    MarkDirty(lane[i]);
+                }
+                break;
+            }
+
+            case LaneCommandKind::ResetLane:
+                for (Line& line : GetLiveLane(center, command.lane)) {
+                    constexpr Game NewGame{};
+                    line.update.round = 0u;
+                    line.update.score = static_cast<std::uint16_t>(NewGame.GetScore());
+                    line.update.provisionalScore = static_cast<std::uint16_t>(NewGame.GetProvisionalScore());
+                    line.update.maxPossibleScore = static_cast<std::uint16_t>(NewGame.GetMaxPossibleScore());
+                    MarkDirty(line);
+                }
+                break;
+            }
+        }
+
+        // writes a message with every line that changed since the last one, returning how many lines it carries
+        //-- a message goes out even when nothing changed, so replicas can tell an idle node from a lost message
+        constexpr size_t Publish(std::vector<std::uint8_t>& message) {
+            std::sort(dirtyKeys.begin(), dirtyKeys.end());
+            BeginMessage(message, false, dirtyKeys.size());
+
+            size_t written = 0u;
+            for (std::uint32_t const key : dirtyKeys) {
+                Line& line = *Find(key);
+                line.update.Encode(message.data() + LeaderboardHeader::Size + written++ * LeaderboardUpdate::Size);
+                line.isDirty = false;
+            }
+            dirtyKeys.clear();
+            std::erase_if(lines, [](Line const& line) { return line.update.isRemoved; });
+
+            return written;
+        }
+
+        // writes a message with every line, for a replica that's new or lost track of this node
+        constexpr size_t PublishSnapshot(std::vector<std::uint8_t>& message) {
+            std::erase_if(lines, [](Line const& line) { return line.update.isRemoved; });
+            BeginMessage(message, true, lines.size());
+
+            for (size_t i = 0u; i < lines.size(); i++) {
+                lines[i].update.Encode(message.data() + LeaderboardHeader::Size + i * LeaderboardUpdate::Size);
+                lines[i].isDirty = false;
+            }
+            dirtyKeys.clear();
+
+            return lines.size();
+        }
+
+        // the bowler's line as the next message will have it, or nothing if there's no such bowler
+        constexpr std::optional<LeaderboardUpdate> GetLine(std::uint16_t center, std::uint8_t lane, std::uint8_t bowler) const {
+            auto const line = std::lower_bound(lines.begin(), lines.end(), LeaderboardUpdate::MakeKey(center, lane, bowler), IsBefore);
+            return line != lines.end() && line->update.GetKey() == LeaderboardUpdate::MakeKey(center, lane, bowler) && !line->update.isRemoved
+                ? std::optional(line->update) : std::nullopt;
+        }
+
+    private:
+        static constexpr bool IsBefore(Line const& line, std::uint32_t key) {
+            return line.update.GetKey() < key;
+        }
+
+        constexpr Line* Find(std::uint32_t key) {
+            auto const line = std::lower_bound(lines.begin(), lines.end(), key, IsBefore);
+            return line != lines.end() && line->update.GetKey() == key ? &*line : nullptr;
+        }
+
+        // the line for a bowler, added at its place in the order if it's new and brought back if it was removed
+        constexpr Line& Upsert(std::uint32_t key) {
+            auto line = std::lower_bound(lines.begin(), lines.end(), key, IsBefore);
+            if (line == lines.end() || line->update.GetKey() != key) {
+                Line added;
+                added.update.center = static_cast<std::uint16_t>(key >> 16u);
+                added.update.lane = static_cast<std::uint8_t>(key >> 8u);
+                added.update.bowler = static_cast<std::uint8_t>(key);
+                line = lines.insert(line, added);
+            }
+            line->update.isRemoved = false;
+
+            return *line;
+        }
+
+        // the lines of a lane's current bowlers, leaving out places emptied since the last message
+        constexpr std::span<Line> GetLiveLane(std::uint16_t center, std::uint8_t lane) {
+            auto const first = std::lower_bound(lines.begin(), lines.end(), LeaderboardUpdate::MakeKey(center, lane, 0u), IsBefore);
+            auto last = first;
+            for (; last != lines.end() && last->update.center == center && last->update.lane == lane && !last->update.isRemoved; ++last) {
+            }
+
+            return { first, last };
+        }
+
+        constexpr void MarkDirty(Line& line) {
+            if (!line.isDirty) {
+                line.isDirty = true;
+                dirtyKeys.push_back(line.update.GetKey());
+            }
+        }
+
+        constexpr void BeginMessage(std::vector<std::uint8_t>& message, bool isSnapshot, size_t updateCount) {
+            message.resize(LeaderboardHeader::Size + updateCount * LeaderboardUpdate::Size);
+            LeaderboardHeader header;
+            header.isSnapshot = isSnapshot;
+            header.node = node;
+            header.sequence = ++sequence;
+            header.updateCount = static_cast<std::uint32_t>(updateCount);
+            header.Encode(message.data());
+        }
+    };
+
+    // what applying a replication message did
+    enum class ReplicationResult : std::uint8_t {
+        Applied,
+        Duplicate,      // the message was older than what the replica already has from that node, so it was skipped
+        NeedsSnapshot,  // a message from the node went missing, so nothing more from it applies until its next snapshot
+        Invalid,
+    };
+
+    // Answers leaderboard queries across every node, from the replication messages the nodes publish.
+    //-- every center is scored on one node only, so each node's messages own the lines of its centers outright
+    class LeaderboardReplica {
+    public:
+        static constexpr size_t MaxNodes = 1024u;
+
+    private:
+        struct Line {
+            LeaderboardUpdate   update;
+            std::uint16_t       node    = 0u;
+        };
+
+        // how far the replica has followed a node
+        struct Source {
+            std::uint32_t   sequence    = 0u;
+            bool            isSynced    = false;
+        };
+
+        std::vector<Line>       lines;      // ordered by key
+        std::vector<Source>     sources;    // grown to the highest node heard from
+
+    public:
+        constexpr ReplicationResult Apply(std::span<const std::uint8_t> message) {
+            std::optional<LeaderboardHeader> const header = LeaderboardHeader::Decode(message);
+            if (!header || header->node >= MaxNodes) {
+                return ReplicationResult::Invalid;
+            }
+
+            sources.resize(std::max<size_t>(sources.size(), header->node + 1u));
+            Source& source = sources[header->node];
+            // snapshots included, as a delayed one would take the node's lines back to before what the replica already has
+            if (source.isSynced && header->sequence <= source.sequence) {
+                return ReplicationResult::Duplicate;
+            }
+            if (!header->isSnapshot) {
+                // a node's first message follows on from nothing, so only a node the replica lost track of needs a snapshot
+                if (header->sequence != source.sequence + 1u || (!source.isSynced && source.sequence != 0u)) {
+                    source.isSynced = false;
+                    return ReplicationResult::NeedsSnapshot;
+                }
+            }
+            else {
+                std::erase_if(lines, [&](Line const& line) { return line.node == header->node; });
+            }
+
+            for (size_t i = 0u; i < header->updateCount; i++) {
+                Merge(LeaderboardUpdate::Decode(message.data() + LeaderboardHeader::Size + i * LeaderboardUpdate::Size), header->node);
+            }
+            source = { header->sequence, true };
+
+            return ReplicationResult::Applied;
+        }
+
+        // writes the best lines from the highest score down, returning how many were written
+        //-- ties go to the line that can still score more, then to the lowest center, lane and place
+        constexpr size_t GetLeaders(std::span<LeaderboardUpdate> out) const {
+            std::vector<Line> leaders(std::min(out.size(), lines.size()));
+            std::partial_sort_copy(lines.begin(), lines.end(), leaders.begin(), leaders.end(), [](Line const& line, Line const& other) { return IsAhead(line.update, other.update); });
+            std::transform(leaders.begin(), leaders.end(), out.begin(), [](Line const& line) { return line.update; });
+
+            return leaders.size();
+        }
+
+        // the bowler's line, or nothing if no node has published one
+        constexpr std::optional<LeaderboardUpdate> GetLine(std::uint16_t center, std::uint8_t lane, std::uint8_t bowler) const {
+            std::uint32_t const key = LeaderboardUpdate::MakeKey(center, lane, bowler);
+            auto const line = std::lower_bound(lines.begin(), lines.end(), key, IsBefore);
+            return line != lines.end() && line->update.GetKey() == key ? std::optional(line->update) : std::nullopt;
+        }
+
+        constexpr size_t GetLineCount() const {
+            return lines.size();
+        }
+
+        // whether the replica has everything a node has published, and so is answering with its latest lines
+        constexpr bool IsSynced(std::uint16_t node) const {
+            return node < sources.size() && sources[node].isSynced;
+        }
+
+    private:
+        static constexpr bool IsBefore(Line const& line, std::uint32_t key) {
+            return line.update.GetKey() < key;
+        }
+
+        static constexpr bool IsAhead(LeaderboardUpdate const& line, LeaderboardUpdate const& other) {
+            if (line.score != other.score) {
+                return line.score > other.score;
+            }
+
+            return line.maxPossibleScore != other.maxPossibleScore ? line.maxPossibleScore > other.maxPossibleScore : line.GetKey() < other.GetKey();
+        }
+
+        constexpr void Merge(LeaderboardUpdate const& update, std::uint16_t node) {
+            auto const line = std::lower_bound(lines.begin(), lines.end(), update.GetKey(), IsBefore);
+            bool const isKnown = line != lines.end() && line->update.GetKey() == update.GetKey();
+            if (update.isRemoved) {
+                if (isKnown) {
+                    lines.erase(line);
+                }
+            }
+            else if (isKnown) {
+                *line = { update, node };
+            }
+            else {
+                lines.insert(line, { update, node });
+            }
+        }
+    };
+} // namespace ExperisBowling
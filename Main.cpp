@@ -1,107 +1,1006 @@
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include "BatchScorer.hpp"
 #include <cctype>
+#include <charconv>
+#include <chrono>
+#include "Crc32.hpp"
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include "DifferentialTesting.hpp"
 #include <format>
+#include "FrameExport.hpp"
+#include <fstream>
 #include "Game.hpp"
-#include <iomanip>
+#include "GamePool.hpp"
+#include "GameValidation.hpp"
+#include "Instrumentation.hpp"
 #include <iostream>
-#include <sstream>
+#include "LaneManager.hpp"
+#include "LeaderboardReplica.hpp"
+#include "MappedFile.hpp"
+#include <memory>
+#include "OutcomeSimulator.hpp"
+#include <optional>
+#include "Rescore.hpp"
+#include "RollJournal.hpp"
+#include "RollStream.hpp"
+#include "ScoreBoard.hpp"
+#include "ScoringProtocol.hpp"
+#include "ScoringServer.hpp"
+#include "ScoringTables.hpp"
+#include "ShardRouting.hpp"
+#include <span>
+#include "StreamScorer.hpp"
 #include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "WorkStealingPool.hpp"
 
 using namespace ExperisBowling;
 
-// creates a string to present the bowling game in a user-friendly format, like a console
-static std::string FormatScore(Game const& game) {
-    std::stringstream ss;
-    unsigned currentFrameIndex = game.GetCurrentRoundIndex();
+// executes the given bowling game example - strike and spare calls can be replaced with 10s and appropriate numbers, respectively
+template <class PlayedGame = Game>
+consteval PlayedGame RunExampleGame() {
+    PlayedGame ex;
+    ex.Roll(8); ex.RollSpare();
+    ex.Roll(5); ex.Roll(4);
+    ex.Roll(9); ex.Roll(0);
+    ex.RollStrike();
+    ex.RollStrike();
+    ex.Roll(5); ex.RollSpare();
+    ex.Roll(5); ex.Roll(3);
+    ex.Roll(6); ex.Roll(3);
+    ex.Roll(9); ex.RollSpare();
+    ex.Roll(9); ex.RollSpare(); ex.RollStrike();
 
-    for (unsigned i = 0u; i < game.FinalFrame; i++) {
-        if (i == currentFrameIndex) {
-            ss << std::string(48, 'v') << "\n";
+    return ex;
+}
+
+// the raw pin counts of the example game
+static constexpr std::array<std::uint8_t, 19u> ExampleRolls = { 8, 2, 5, 4, 9, 0, 10, 10, 5, 5, 5, 3, 6, 3, 9, 1, 9, 1, 10 };
+
+// the same example game, scored in a single pass from its raw pin counts
+consteval Game RunExampleGameFromRolls() {
+    return Game::FromRolls(ExampleRolls).value();
+}
+
+static_assert(RunExampleGameFromRolls() == RunExampleGame());
+
+// plays the example game through both scoring engines, checking that every frame comes out the same
+consteval bool CheckTableScoring() {
+    Game const branching = RunExampleGame();
+    TableGame const table = RunExampleGame<TableGame>();
+    for (size_t i = 0u; i < Game::MaxFrames; i++) {
+        if (branching.GetFrame(i) != table.GetFrame(i)) {
+            return false;
         }
+    }
+
+    return branching.GetCurrentRoundIndex() == table.GetCurrentRoundIndex()
+        && branching.GetScore() == table.GetScore()
+        && branching.GetProvisionalScore() == table.GetProvisionalScore();
+}
 
-        ss << "Round " << std::setw(2) << i + 1u << " - " << "[";
+static_assert(CheckTableScoring());
 
-        if (game.GetFrame(i).isStrike) {
-            ss << " X" << ", " << " _";
+// takes the example game all the way back and forward again through the roll log, then corrects its last roll
+consteval bool CheckRollLog() {
+    Game game = RunExampleGame();
+    while (game.Undo()) {
+    }
+    if (game != Game()) {
+        return false;
+    }
+
+    while (game.Redo()) {
+    }
+    if (game != RunExampleGame()) {
+        return false;
+    }
+
+    std::array<std::uint8_t, ExampleRolls.size()> amendedRolls = ExampleRolls;
+    amendedRolls.back() = 5u;
+
+    return game.Amend(static_cast<unsigned>(amendedRolls.size() - 1u), 5u) && game == Game::FromRolls(amendedRolls);
+}
+
+static_assert(CheckRollLog());
+
+// a roll stream header only fits a file with a byte for each of its games, and room for its index if it has one
+//-- a game count far past the file's size is refused before it gets anywhere near the index arithmetic
+consteval bool CheckRollStreamHeader() {
+    RollStreamHeader indexed;
+    indexed.gameCount = 3u;
+    indexed.flags = RollStreamHeader::HasIndexFlag;
+    indexed.indexOffset = RollStreamHeader::Size + 3u;
+    size_t const indexedSize = RollStreamHeader::Size + 3u + sizeof(std::uint64_t);
+
+    RollStreamHeader huge = indexed;
+    huge.gameCount = UINT64_MAX;
+    RollStreamHeader unindexed;
+    unindexed.gameCount = UINT64_MAX - 1u;
+    std::array<std::uint8_t, RollStreamHeader::Size> const encoded = huge.Encode();
+    std::optional<RollStreamHeader> const decoded = RollStreamHeader::Decode(encoded);
+
+    return indexed.GetDataEnd(indexedSize) == RollStreamHeader::Size + 3u && !indexed.GetDataEnd(indexedSize - 1u)
+        && decoded && !decoded->GetDataEnd(encoded.size() + 2u) && !huge.GetDataEnd(indexedSize) && !unindexed.GetDataEnd(RollStreamHeader::Size + 2u)
+        && !unindexed.GetDataEnd(0u);
+}
+
+static_assert(CheckRollStreamHeader());
+
+// scores the example game in every lane of the batch kernel, checking each lane against the scalar engine
+consteval bool CheckBatchScorer() {
+    using Scorer = BatchScorer<>;
+
+    Scorer::Rolls rolls;
+    for (size_t lane = 0u; lane < Scorer::Lanes; lane++) {
+        rolls.SetGame(lane, ExampleRolls);
+    }
+
+    Scorer::Scores scores;
+    Scorer::Score(rolls, scores);
+    for (size_t lane = 0u; lane < Scorer::Lanes; lane++) {
+        if (!Scorer::MatchesGame(scores, lane, ExampleRolls)) {
+            return false;
         }
-        else {
-            ss << std::setw(2) << game.GetFrame(i).pinsOnFirstRoll.value_or(0u) << ", " << std::setw(2);
+    }
 
-            if (game.GetFrame(i).isSpare) {
-                ss << "/";
-            }
-            else if (game.GetFrame(i).isStrike) {
-                ss << "X";
+    return true;
+}
+
+static_assert(CheckBatchScorer());
+
+// exercises the pool's free list and handle generations, and a lane's bowler order on top of it
+consteval bool CheckLaneManager() {
+    LaneManager<2u, 2u> center;
+    std::optional<GameHandle> const first = center.AddBowler(0u);
+    std::optional<GameHandle> const second = center.AddBowler(0u);
+    if (!first || !second || center.AddBowler(0u) || center.AddBowler(2u)) {
+        return false;
+    }
+
+    center.GetGame(0u, 1u)->TryRollStrike();
+    center.RemoveBowler(0u, 0u);
+    if (center.GetPool().IsValid(*first) || center.GetGame(0u, 0u)->GetScore() != 0u || center.GetGame(0u, 0u)->GetCurrentRoundIndex() != 1u) {
+        return false;
+    }
+
+    // the released slot is reused, but the old handle must not reach the new game
+    std::optional<GameHandle> const reused = center.AddBowler(1u);
+    if (!reused || reused->index != first->index || center.GetPool().Get(*first) != nullptr) {
+        return false;
+    }
+
+    center.ResetLane(0u);
+    size_t activeGames = 0u;
+    center.GetPool().ForEachActive([&](GameHandle, Game const& game) { activeGames += game.GetCurrentRoundIndex() == 0u; });
+
+    return activeGames == 2u && center.GetPool().GetActiveCount() == 2u;
+}
+
+static_assert(CheckLaneManager());
+
+// plays a game of the given rules one roll at a time, checking it against scoring the same rolls in one go
+template <class PlayedGame>
+consteval std::optional<PlayedGame> PlayVariant(std::span<const std::uint8_t> rolls) {
+    PlayedGame game;
+    for (std::uint8_t pinCount : rolls) {
+        if (!game.TryRoll(pinCount)) {
+            return std::nullopt;
+        }
+    }
+    if (game != PlayedGame::FromRolls(rolls)) {
+        return std::nullopt;
+    }
+
+    return game;
+}
+
+// scores the rule variants, which share the ten-pin engine but are sized and bounded by their own rules
+consteval bool CheckRuleVariants() {
+    constexpr std::array<std::uint8_t, 12u> candlepinStrikes = { 10u, 10u, 10u, 10u, 10u, 10u, 10u, 10u, 10u, 10u, 10u, 10u };
+    constexpr std::array<std::uint8_t, 12u> fivePinStrikes = { 15u, 15u, 15u, 15u, 15u, 15u, 15u, 15u, 15u, 15u, 15u, 15u };
+    constexpr std::array<std::uint8_t, 30u> candlepinGutters = {};
+
+    // a spare on the second ball earns one bonus roll, clearing the pins on the third ball earns none
+    constexpr std::array<std::uint8_t, 8u> candlepinBalls = { 3u, 7u, 5u, 0u, 1u, 2u, 3u, 5u };
+
+    std::optional<CandlepinGame> const perfect = PlayVariant<CandlepinGame>(candlepinStrikes);
+    std::optional<FivePinGame> const fivePinPerfect = PlayVariant<FivePinGame>(fivePinStrikes);
+    std::optional<CandlepinGame> const gutters = PlayVariant<CandlepinGame>(candlepinGutters);
+    std::optional<CandlepinGame> balls = PlayVariant<CandlepinGame>(candlepinBalls);
+    if (!perfect || !fivePinPerfect || !gutters || !balls) {
+        return false;
+    }
+    if (!perfect->IsGameComplete() || perfect->GetScore() != 300u || !fivePinPerfect->IsGameComplete() || fivePinPerfect->GetScore() != 450u) {
+        return false;
+    }
+    if (!gutters->IsGameComplete() || balls->GetFrame(0u).totalScore != 15u || balls->GetFrame(2u).totalScore != 31u || balls->GetCurrentRoundIndex() != 3u) {
+        return false;
+    }
+
+    while (balls->Undo()) {
+    }
+
+    return *balls == CandlepinGame() && !CandlepinGame().TryRoll(11u) && FivePinGame().TryRoll(15u);
+}
+
+static_assert(CheckRuleVariants());
+
+// walks every way the last rolls of a game can be played, against the reference scorer
+//-- the prefixes leave the bonus rolls of a strike, the bonus roll of a spare, and a final frame after its first ball to go,
+//-- each with strikes still pending from the frames before
+consteval bool CheckFinalRolls() {
+    constexpr std::array<std::uint8_t, 10u> strikes = { 10u, 10u, 10u, 10u, 10u, 10u, 10u, 10u, 10u, 10u };
+    constexpr std::array<std::uint8_t, 11u> spare = { 10u, 10u, 10u, 10u, 10u, 10u, 10u, 10u, 10u, 3u, 7u };
+
+    GameValidator<Game>::Report const strikeReport = GameValidator<Game>::Walk(strikes);
+    GameValidator<TableGame>::Report const tableReport = GameValidator<TableGame>::Walk(strikes);
+    GameValidator<Game>::Report const spareReport = GameValidator<Game>::Walk(spare);
+    GameValidator<Game>::Report const openReport = GameValidator<Game>::Walk(std::span(spare).first(10u));
+    if (strikeReport.mismatches != 0u || tableReport.mismatches != 0u || spareReport.mismatches != 0u || openReport.mismatches != 0u) {
+        return false;
+    }
+
+    // the final frame on its own can be played 241 ways, and its games score up to 30
+    ScoreDistribution<> const finalFrames = CountGames(Game::FinalFrame - 1u);
+    std::uint64_t finalFrameGames = 0u;
+    for (std::uint64_t games : finalFrames) {
+        finalFrameGames += games;
+    }
+
+    return strikeReport.games == 76u && spareReport.games == 11u && openReport.games == 7u + 11u
+        && finalFrameGames == 241u && finalFrames[30u] == 1u;
+}
+
+static_assert(CheckFinalRolls());
+
+// checks the score bounds at the start, middle and end of a game, and a head-to-head between two games
+consteval bool CheckScoreBounds() {
+    Game const example = RunExampleGame();
+    Game nineStrikes;
+    for (unsigned i = 0u; i < Game::FinalFrame - 1u; i++) {
+        nineStrikes.TryRollStrike();
+    }
+    Game perfect = nineStrikes;
+    while (!perfect.IsGameComplete()) {
+        perfect.TryRollStrike();
+    }
+
+    return Game().GetMinPossibleScore() == 0u && Game().GetMaxPossibleScore() == 300u && FivePinGame().GetMaxPossibleScore() == 450u
+        && example.GetMinPossibleScore() == example.GetScore() && example.GetMaxPossibleScore() == example.GetScore()
+        && nineStrikes.GetMinPossibleScore() == 240u && nineStrikes.GetMaxPossibleScore() == 300u
+        && nineStrikes.CanStillWin(example) && !nineStrikes.CanStillWin(perfect) && !example.CanStillWin(nineStrikes);
+}
+
+static_assert(CheckScoreBounds());
+
+// plays the example game through the scoring service in one datagram, with other lanes' commands mixed into the batch
+//-- commands for one lane have to apply in arrival order across datagrams, and a truncated datagram gets no reply
+consteval bool CheckScoringService() {
+    using Service = ScoringService<2u, 2u, 4u>;
+    Service::Lanes lanes;
+    Service service(lanes);
+
+    std::array<ScoringDatagram, 3u> requests{};
+    std::array<LaneCommand, ExampleRolls.size() + 2u> commands{};
+    commands[0] = { LaneCommandKind::AddBowler, 1u };
+    for (size_t i = 0u; i < ExampleRolls.size(); i++) {
+        commands[i + 1u] = { LaneCommandKind::Roll, 1u, 0u, ExampleRolls[i] };
+    }
+    commands.back() = { LaneCommandKind::Roll, 0u, 0u, 5u };
+
+    ScoringHeader{ ScoringHeader::CurrentVersion, static_cast<std::uint8_t>(commands.size()), 7u }.Encode(requests[0].bytes.data());
+    for (size_t i = 0u; i < commands.size(); i++) {
+        commands[i].Encode(requests[0].bytes.data() + ScoringHeader::Size + i * LaneCommand::Size);
+    }
+    requests[0].size = ScoringHeader::Size + commands.size() * LaneCommand::Size;
+
+    ScoringHeader{ ScoringHeader::CurrentVersion, 1u, 8u }.Encode(requests[1].bytes.data());
+    LaneCommand{ LaneCommandKind::AddBowler, 0u }.Encode(requests[1].bytes.data() + ScoringHeader::Size);
+    requests[1].size = ScoringHeader::Size + LaneCommand::Size;
+
+    requests[2] = requests[1];
+    requests[2].size--;
+
+    std::array<ScoringDatagram, 3u> replies{};
+    if (service.Process(requests, replies) != 2u) {
+        return false;
+    }
+
+    std::optional<ScoringHeader> const header = ScoringHeader::Decode(replies[0].GetBytes());
+    ScoreDelta delta;
+    size_t offset = ScoringHeader::Size;
+    for (size_t i = 0u; i < commands.size() - 1u; i++) {
+        offset += Service::DecodeDelta(replies[0].bytes.data() + offset, delta);
+        if (delta.status != CommandStatus::Applied) {
+            return false;
+        }
+    }
+    ScoreDelta noBowler;
+    offset += Service::DecodeDelta(replies[0].bytes.data() + offset, noBowler);
+
+    Game const example = RunExampleGame();
+    return header && header->sequence == 7u && header->commandCount == commands.size() && offset == replies[0].size
+        && delta.lane == 1u && delta.score == example.GetScore() && delta.maxPossibleScore == example.GetScore() && delta.frameCount == 1u
+        && noBowler.status == CommandStatus::NoSuchBowler && lanes.GetBowlerCount(0u) == 1u
+        && ScoringHeader::Decode(replies[1].GetBytes())->sequence == 8u && service.GetProcessedCommands() == commands.size() + 1u;
+}
+
+static_assert(CheckScoringService());
+
+// sends a controller's datagram of three rolls twice, the way the server does when the first reply is lost
+//-- the resend is answered with the first reply, the game only takes its rolls once, and an older datagram is dropped
+consteval bool CheckResendGuard() {
+    using Service = ScoringService<1u, 1u, 2u>;
+    Service::Lanes lanes;
+    Service service(lanes);
+    ResendGuard<2u> guard;
+    lanes.AddBowler(0u);
+
+    std::array<ScoringDatagram, 1u> requests{};
+    ScoringHeader const header{ ScoringHeader::CurrentVersion, 3u, 41u };
+    header.Encode(requests[0].bytes.data());
+    for (size_t i = 0u; i < header.commandCount; i++) {
+        LaneCommand{ LaneCommandKind::Roll, 0u, 0u, ExampleRolls[i] }.Encode(requests[0].bytes.data() + ScoringHeader::Size + i * LaneCommand::Size);
+    }
+    requests[0].size = ScoringHeader::Size + header.commandCount * LaneCommand::Size;
+
+    std::array<ScoringDatagram, 1u> replies{};
+    if (guard.Admit(7u, header) != DatagramAdmission::New || service.Process(requests, replies) != 1u) {
+        return false;
+    }
+    guard.Remember(7u, replies[0]);
+
+    ScoringDatagram const* const resent = guard.Admit(7u, header) == DatagramAdmission::Repeat ? guard.FindReply(7u, header.sequence) : nullptr;
+    ScoringHeader const older{ ScoringHeader::CurrentVersion, 3u, header.sequence - 1u };
+    return resent != nullptr && std::equal(resent->GetBytes().begin(), resent->GetBytes().end(), replies[0].GetBytes().begin(), replies[0].GetBytes().end())
+        && lanes.GetGame(0u, 0u)->GetRollCount() == header.commandCount && service.GetProcessedCommands() == header.commandCount
+        && guard.Admit(7u, older) == DatagramAdmission::Stale && guard.Admit(8u, older) == DatagramAdmission::New;
+}
+
+static_assert(CheckResendGuard());
+
+// every value lands in a bucket no more than an eighth wider than itself, and percentiles report the bucket they fall in
+consteval bool CheckLatencyHistogram() {
+    for (std::uint64_t ticks = 0u; ticks < 4096u; ticks++) {
+        std::uint64_t const upperBound = LatencyHistogram::GetUpperBound(LatencyHistogram::GetBucket(ticks));
+        if (upperBound < ticks || upperBound > ticks + ticks / LatencyHistogram::SubBuckets) {
+            return false;
+        }
+    }
+
+    LatencyHistogram histogram;
+    for (std::uint64_t ticks = 1u; ticks <= 1000u; ticks++) {
+        histogram.Record(ticks);
+    }
+    histogram.Record(std::uint64_t{ 1u } << 40u);
+
+    return histogram.GetCount() == 1001u && histogram.GetPercentile(0.5) == 511u && histogram.GetPercentile(0.99) == 1023u
+        && histogram.GetPercentile(1.0) == UINT32_MAX && LatencyHistogram::GetBucket(UINT32_MAX) == LatencyHistogram::BucketCount - 1u;
+}
+
+static_assert(CheckLatencyHistogram());
+
+// plays games out with a bowler who always strikes, and one whose rolls come from the example game
+consteval bool CheckOutcomeSimulator() {
+    RollModel<> striker;
+    striker.Observe(Game::NumPins, Game::NumPins);
+    RollSampler<> const strikes(striker);
+
+    Game nineStrikes;
+    for (unsigned i = 0u; i < Game::FinalFrame - 1u; i++) {
+        nineStrikes.TryRollStrike();
+    }
+
+    RollModel<> example;
+    RollSampler<> const exampleRolls(example);
+    SimulationRng rng = { 1u };
+    unsigned const uniformScore = OutcomeSimulator<>::PlayOut(Game(), exampleRolls, rng);
+
+    // counting out the rest of a game has to score the same rolls the same as playing them does
+    for (size_t prefix = 0u; prefix <= ExampleRolls.size(); prefix += 3u) {
+        Game const start = Game::FromRolls(std::span(ExampleRolls).first(prefix)).value();
+        for (std::uint64_t seed = 0u; seed < 8u; seed++) {
+            SimulationRng counted = { seed };
+            SimulationRng played = { seed };
+            Game game = start;
+            while (!game.IsGameComplete()) {
+                game.TryRoll(exampleRolls.Sample(game.GetStandingPins(), static_cast<std::uint32_t>(played.Next() >> 32u)));
             }
-            else {
-                ss << game.GetFrame(i).pinsOnSecondRoll.value_or(0u);
+            if (OutcomeSimulator<>::PlayOut(start, exampleRolls, counted) != game.GetScore() || counted.state != played.state) {
+                return false;
             }
         }
+    }
 
+    return example.ObserveGame(ExampleRolls) && !example.ObserveGame(std::array<std::uint8_t, 2u>{ 6u, 6u })
+        && example.GetCounts(Game::NumPins)[Game::NumPins] == 3u && example.GetCounts(1u)[1u] == 2u
+        && OutcomeSimulator<>::PlayOut(Game(), strikes, rng) == 300u && OutcomeSimulator<>::PlayOut(nineStrikes, strikes, rng) == 300u
+        && OutcomeSimulator<>::PlayOut(RunExampleGame(), strikes, rng) == RunExampleGame().GetScore() && uniformScore <= 300u
+        && Game().GetStandingPins() == Game::NumPins && RunExampleGame().GetStandingPins() == 0u;
+}
 
-        if (i == game.FinalFrame - 1u) {
-            ss << ", ";
+static_assert(CheckOutcomeSimulator());
 
-            unsigned pins = game.GetFrame(i + 1u).pinsOnFirstRoll.value_or(0u);
-            if (pins == Game::NumPins) {
-                ss << "X";
-            }
-            else {
-                ss << pins;
+// saves games at every point of the example and restores them, undone rolls included, and turns away damaged checkpoints
+consteval bool CheckCheckpoints() {
+    for (size_t prefix = 0u; prefix <= ExampleRolls.size(); prefix++) {
+        Game game = Game::FromRolls(std::span(ExampleRolls).first(prefix)).value();
+        game.Undo();
+        std::optional<Game> restored = Game::FromCheckpoint(game.SaveCheckpoint());
+        if (!restored || *restored != game || restored->GetRollCount() != game.GetRollCount() || restored->Redo() != game.Redo() || *restored != game) {
+            return false;
+        }
+    }
+
+    Game::Checkpoint const checkpoint = RunExampleGame().SaveCheckpoint();
+    Game::Checkpoint flippedBit = checkpoint;
+    flippedBit.frames[3] ^= 1u << 5u;
+    Game::Checkpoint otherRules = checkpoint;
+    otherRules.numPins = 5u;
+    Game::Checkpoint laterFormat = checkpoint;
+    laterFormat.formatVersion++;
+    Game::Checkpoint badChecksum = checkpoint;
+    badChecksum.checksum ^= 1u;
+
+    Game overwritten = RunExampleGame();
+    overwritten.Reset();
+
+    // the standard check value, so checkpoints are checked by the same CRC-32C everyone else uses
+    constexpr std::array<std::uint8_t, 9u> CheckInput = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+    if (Crc32c().Update(CheckInput).Get() != 0xe3069283u) {
+        return false;
+    }
+
+    return !Game::FromCheckpoint(flippedBit) && !Game::FromCheckpoint(otherRules) && !Game::FromCheckpoint(laterFormat)
+        && !Game::FromCheckpoint(badChecksum) && !overwritten.RestoreCheckpoint(badChecksum) && overwritten == Game()
+        && overwritten.RestoreCheckpoint(checkpoint) && overwritten == RunExampleGame()
+        && BasicGame<TenPinRules, TableScoring>::FromCheckpoint(std::bit_cast<BasicGame<TenPinRules, TableScoring>::Checkpoint>(checkpoint)).has_value();
+}
+
+static_assert(CheckCheckpoints());
+
+// journals two games rolled in turn, snapshots them partway, and replays the rest of the journal onto the snapshot
+//-- a torn or damaged record ends the journal, so neither it nor anything after it is replayed
+consteval bool CheckRollJournal() {
+    constexpr size_t SnapshotRolls = 7u;
+
+    std::vector<std::uint8_t> bytes(JournalHeader::Size);
+    std::array<std::uint8_t, JournalHeader::Size> const header = JournalHeader::Encode();
+    std::copy(header.begin(), header.end(), bytes.begin());
+
+    std::array<Game, 2u> snapshot;
+    std::uint64_t sequence = 0u;
+    std::uint64_t snapshotSequence = 0u;
+    for (size_t i = 0u; i < ExampleRolls.size(); i++) {
+        for (std::uint32_t game = 0u; game < snapshot.size(); game++) {
+            JournalRecord const record = { ++sequence, GameHandle{ game, 1u }, 3u, ExampleRolls[i] };
+            bytes.resize(bytes.size() + JournalRecord::Size);
+            record.Encode(bytes.data() + bytes.size() - JournalRecord::Size);
+            if (i < SnapshotRolls) {
+                snapshot[game].TryRoll(ExampleRolls[i]);
+                snapshotSequence = sequence;
             }
+        }
+    }
+
+    std::array<Game, 2u> games = snapshot;
+    auto const findGame = [&](JournalRecord const& record) { return record.game.index < games.size() ? &games[record.game.index] : nullptr; };
+    JournalReplay const replay = ReplayJournal(bytes, snapshotSequence, findGame);
+    if (games[0] != RunExampleGame() || games[1] != RunExampleGame() || replay.replayedRolls != 2u * (ExampleRolls.size() - SnapshotRolls)
+        || replay.rejectedRolls != 0u || replay.games != 2u || replay.lastSequence != sequence) {
+        return false;
+    }
+
+    // cut the journal off partway through a record, then damage a byte of an earlier one
+    games = snapshot;
+    bytes.resize(bytes.size() - JournalRecord::Size / 2u);
+    bytes[JournalHeader::Size + (2u * SnapshotRolls + 1u) * JournalRecord::Size + 2u] ^= 0x10u;
+    JournalScan const scan = ScanJournal(bytes, [](JournalRecord const&) {});
+    JournalReplay const damaged = ReplayJournal(bytes, snapshotSequence, findGame);
+
+    return scan.records == 2u * SnapshotRolls + 1u && damaged.replayedRolls == 1u && games[0] != RunExampleGame()
+        && games[0].GetRollCount() == SnapshotRolls + 1u && games[1] == snapshot[1];
+}
+
+static_assert(CheckRollJournal());
+
+// every engine agrees on the example, on sequences running past their end or over the pins, and on the edges of the final frame
+//-- the minimizer is checked against a stand-in failure: any sequence holding a 7 shrinks to just that roll
+consteval bool CheckDifferentialTesting() {
+    FuzzRolls example;
+    for (std::uint8_t const pins : ExampleRolls) {
+        example.Add(pins);
+    }
+    FuzzRolls pastTheEnd = example;
+    pastTheEnd.Add(0u);
+    FuzzRolls overThePins = example;
+    overThePins.pins[1] = 3u;
+    overThePins.pins[2] = 8u;
+
+    std::array<std::uint8_t, 7u> const decoded = { 0x00u, 0x00u, 0x40u, 0x8bu, 0xffu, 0x12u, 0x55u };
+    FuzzRolls const decodedRolls = RollSequenceFuzzer::Decode(decoded);
+    RollSequenceFuzzer fuzzer(1u);
+    for (int i = 0; i < 8; i++) {
+        if (CheckEveryEngine(fuzzer.Next()) != DifferentialCheck::None) {
+            return false;
+        }
+    }
+
+    auto const failsOnSeven = [](FuzzRolls const& rolls) {
+        return std::find(rolls.pins.begin(), rolls.pins.begin() + rolls.count, 7u) != rolls.pins.begin() + rolls.count ? DifferentialCheck::Score : DifferentialCheck::None;
+    };
+    FuzzRolls withSeven = overThePins;
+    withSeven.pins[4] = 7u;
+    FuzzRolls const minimized = MinimizeFailure(withSeven, DifferentialCheck::Score, failsOnSeven);
+
+    return CheckEveryEngine(example) == DifferentialCheck::None && CheckEveryEngine(pastTheEnd) == DifferentialCheck::None
+        && CheckEveryEngine(overThePins) == DifferentialCheck::None && CheckEveryEngine(decodedRolls) == DifferentialCheck::None
+        && decodedRolls.count == decoded.size() && decodedRolls.pins[0] == Game::NumPins && decodedRolls.pins[2] == 0u && decodedRolls.pins[4] == 0x3fu
+        && minimized.count == 1u && minimized.pins[0] == 7u;
+}
 
-            ss << "] ";
+static_assert(CheckDifferentialTesting());
+
+// every center lands on one node, and a node joining only takes centers over, while a center's lanes spread evenly over the cores
+//-- then the example game is replicated to a leaderboard, through a lost message and the snapshot that recovers from it
+consteval bool CheckShardReplication() {
+    ShardMap const map(4u, 3u);
+    ShardMap const grown(5u, 3u);
+    for (std::uint16_t center = 0u; center < 1000u; center++) {
+        std::uint16_t const node = grown.GetNode(center);
+        if (map.GetNode(center) >= map.GetNodeCount() || (node != map.GetNode(center) && node != 4u)) {
+            return false;
+        }
+    }
+    std::array<size_t, 3u> coreLanes{};
+    for (std::uint8_t lane = 0u; lane < 48u; lane++) {
+        coreLanes[map.GetCore(9u, lane)]++;
+    }
+
+    auto const describe = [](Game const& game, std::uint8_t bowler) {
+        return ScoreDelta{ 3u, bowler, CommandStatus::Applied, RollError::None, static_cast<std::uint8_t>(game.GetCurrentRoundIndex()), 0u,
+            static_cast<std::uint16_t>(game.GetScore()), static_cast<std::uint16_t>(game.GetProvisionalScore()), static_cast<std::uint16_t>(game.GetMaxPossibleScore()) };
+    };
+
+    // two bowlers join lane 3 of center 7, and the first of them bowls the example game
+    LeaderboardPublisher publisher(2u);
+    LeaderboardReplica replica;
+    std::vector<std::uint8_t> message;
+    Game game{};
+    publisher.Observe(7u, { LaneCommandKind::AddBowler, 3u }, describe(game, 0u));
+    publisher.Observe(7u, { LaneCommandKind::AddBowler, 3u }, describe(game, 1u));
+    bool isReplicated = publisher.Publish(message) == 2u && replica.Apply(message) == ReplicationResult::Applied;
+    for (std::uint8_t const pins : ExampleRolls) {
+        game.TryRoll(pins);
+        publisher.Observe(7u, { LaneCommandKind::Roll, 3u, 0u, pins }, describe(game, 0u));
+    }
+    size_t const coalesced = publisher.Publish(message);
+    isReplicated = isReplicated && replica.Apply(message) == ReplicationResult::Applied && replica.Apply(message) == ReplicationResult::Duplicate;
+
+    std::array<LeaderboardUpdate, 4u> leaders{};
+    bool const isLeading = replica.GetLeaders(leaders) == 2u && leaders[0].bowler == 0u && leaders[0].score == RunExampleGame().GetScore()
+        && leaders[0].round == RunExampleGame().GetCurrentRoundIndex() && leaders[1].score == 0u && leaders[1].maxPossibleScore == ReferenceScorer<>::MaxScore;
+
+    // the example bowler leaves, moving the other up, but that message never arrives
+    publisher.Observe(7u, { LaneCommandKind::RemoveBowler, 3u, 0u }, describe(game, 0u));
+    size_t const removal = publisher.Publish(message);
+    publisher.Publish(message);
+    ReplicationResult const afterLoss = replica.Apply(message);
+    bool const isStale = !replica.IsSynced(2u) && replica.GetLine(7u, 3u, 0u)->score == RunExampleGame().GetScore();
+
+    publisher.PublishSnapshot(message);
+    ReplicationResult const afterSnapshot = replica.Apply(message);
+    publisher.Publish(message);
+
+    return coreLanes == std::array<size_t, 3u>{ 16u, 16u, 16u } && isReplicated && coalesced == 1u && isLeading
+        && removal == 2u && afterLoss == ReplicationResult::NeedsSnapshot && isStale
+        && afterSnapshot == ReplicationResult::Applied && replica.Apply(message) == ReplicationResult::Applied && replica.IsSynced(2u)
+        && replica.GetLineCount() == 1u && replica.GetLine(7u, 3u, 0u)->score == 0u && !replica.GetLine(7u, 3u, 1u)
+        && publisher.GetLine(7u, 3u, 0u)->score == 0u && !publisher.GetLine(7u, 3u, 1u)
+        && replica.Apply(std::span(message).first(LeaderboardHeader::Size - 1u)) == ReplicationResult::Invalid;
+}
+
+static_assert(CheckShardReplication());
+
+// a snapshot that turns up after a newer delta is skipped, so it neither takes the line back nor stops the next delta applying
+consteval bool CheckStaleSnapshot() {
+    LeaderboardPublisher publisher(1u);
+    LeaderboardReplica replica;
+    std::vector<std::uint8_t> snapshot;
+    std::vector<std::uint8_t> message;
+    Game game{};
+    auto const roll = [&](std::uint8_t pins) {
+        game.TryRoll(pins);
+        publisher.Observe(4u, { LaneCommandKind::Roll, 0u, 0u, pins }, { 0u, 0u, CommandStatus::Applied, RollError::None,
+            static_cast<std::uint8_t>(game.GetCurrentRoundIndex()), 0u, static_cast<std::uint16_t>(game.GetScore()),
+            static_cast<std::uint16_t>(game.GetProvisionalScore()), static_cast<std::uint16_t>(game.GetMaxPossibleScore()) });
+        publisher.Publish(message);
+        return replica.Apply(message);
+    };
+
+    publisher.Observe(4u, { LaneCommandKind::AddBowler, 0u }, { 0u, 0u, CommandStatus::Applied, RollError::None, 0u, 0u, 0u, 0u, ReferenceScorer<>::MaxScore });
+    publisher.PublishSnapshot(snapshot);
+    bool const isJoined = replica.Apply(snapshot) == ReplicationResult::Applied && roll(ExampleRolls[0]) == ReplicationResult::Applied;
+
+    ReplicationResult const replayed = replica.Apply(snapshot);
+    bool const isKept = replica.GetLine(4u, 0u, 0u)->provisionalScore == ExampleRolls[0];
+
+    return isJoined && replayed == ReplicationResult::Duplicate && isKept && roll(ExampleRolls[1]) == ReplicationResult::Applied
+        && replica.IsSynced(1u) && replica.GetLine(4u, 0u, 0u)->round == game.GetCurrentRoundIndex();
+}
+
+static_assert(CheckStaleSnapshot());
+
+// the example game round-trips through a frame export, by its rolls as the batch kernel scores them and as it's played,
+//-- while a game still in progress is left out and a damaged batch is refused
+consteval bool CheckFrameExport() {
+    Game const example = RunExampleGame();
+    BatchScorer<>::Rolls rolls;
+    BatchScorer<>::Scores scores;
+    rolls.SetGame(0u, ExampleRolls);
+    BatchScorer<>::Score(rolls, scores);
+    std::array<std::uint8_t, Game::FinalFrame> currentScores{};
+    std::array<std::uint16_t, Game::FinalFrame> totalScores{};
+    for (unsigned frame = 0u; frame < Game::FinalFrame; frame++) {
+        currentScores[frame] = scores.currentScore[frame][0];
+        totalScores[frame] = scores.totalScore[frame][0];
+    }
+
+    FrameBatch batch(3u * Game::FinalFrame);
+    batch.AddGame(5u, ExampleRolls, currentScores, totalScores);
+    Game inProgress = example;
+    inProgress.Undo();
+    bool const isSkipped = !batch.AddGame(6u, inProgress);
+    batch.AddGame(7u, example);
+
+    std::vector<std::uint8_t> bytes;
+    FrameExportFormat::EncodeHeader(bytes);
+    batch.Encode(bytes);
+    FrameBatch::EncodeEnd(bytes);
+
+    std::optional<FrameExportReader> reader = FrameExportReader::Open(bytes);
+    std::optional<FrameExportReader::Batch> const read = reader ? reader->Next() : std::nullopt;
+    if (!isSkipped || !read || read->GetRowCount() != 2u * Game::FinalFrame || reader->Next() || !reader->IsComplete()) {
+        return false;
+    }
+
+    for (size_t row = 0u; row < read->GetRowCount(); row++) {
+        unsigned const frame = static_cast<unsigned>(row % Game::FinalFrame);
+        Frame const expected = example.GetFrame(frame);
+        bool const isFinal = frame == Game::FinalFrame - 1u;
+        if (read->GetValue(FrameColumn::Game, row) != (row < Game::FinalFrame ? 5u : 7u) || read->GetValue(FrameColumn::Frame, row) != frame
+            || read->GetValue(FrameColumn::PinsOnFirstRoll, row) != expected.pinsOnFirstRoll
+            || read->GetValue(FrameColumn::PinsOnSecondRoll, row) != (expected.isStrike ? std::nullopt : expected.pinsOnSecondRoll)
+            || read->GetValue(FrameColumn::IsStrike, row) != unsigned{ expected.isStrike } || read->GetValue(FrameColumn::IsSpare, row) != unsigned{ expected.isSpare }
+            || read->GetValue(FrameColumn::CurrentScore, row) != expected.currentScore || read->GetValue(FrameColumn::TotalScore, row) != expected.totalScore
+            || read->GetValue(FrameColumn::PinsOnFirstBonusRoll, row) != (isFinal ? std::optional<unsigned>(Game::NumPins) : std::nullopt)
+            || read->GetValue(FrameColumn::PinsOnSecondBonusRoll, row)) {
+            return false;
+        }
+    }
+
+    bytes[FrameExportFormat::GetHeaderSize() + FrameExportFormat::BatchHeaderSize + 3u] ^= 0x01u;
+    std::optional<FrameExportReader> damaged = FrameExportReader::Open(bytes);
+
+    return damaged && !damaged->Next() && !damaged->IsComplete() && !FrameExportReader::Open(std::span(bytes).first(4u));
+}
+
+static_assert(CheckFrameExport());
+
+// writes one line per game: the final score followed by the ten frame totals, or "invalid"
+//-- lines are formatted into a fixed block that is flushed whenever it fills up
+class GameScoreWriter {
+private:
+    static constexpr size_t MaxLineLength = (Game::FinalFrame + 1u) * 4u + 1u;
+
+    std::ostream&               out;
+    std::array<char, 1u << 16u> block;
+    size_t                      used = 0u;
+
+public:
+    explicit GameScoreWriter(std::ostream& out) : out(out) {
+    }
+
+    GameScoreWriter(GameScoreWriter const&) = delete;
+    GameScoreWriter& operator=(GameScoreWriter const&) = delete;
+
+    ~GameScoreWriter() {
+        Flush();
+    }
+
+    void Write(GameScore const& score) {
+        if (block.size() - used < MaxLineLength) {
+            Flush();
+        }
+
+        char* cursor = block.data() + used;
+        if (!score.isValid) {
+            static constexpr std::string_view Invalid = "invalid\n";
+            cursor = std::copy(Invalid.begin(), Invalid.end(), cursor);
         }
         else {
-            ss << "] " << std::string(3, ' ');
+            cursor = std::to_chars(cursor, block.data() + block.size(), score.finalScore).ptr;
+            for (std::uint16_t total : score.frameTotals) {
+                *cursor++ = ' ';
+                cursor = std::to_chars(cursor, block.data() + block.size(), total).ptr;
+            }
+            *cursor++ = '\n';
         }
+        used = static_cast<size_t>(cursor - block.data());
+    }
+
+    void Flush() {
+        out.write(block.data(), static_cast<std::streamsize>(used));
+        used = 0u;
+    }
+};
 
-        ss << "Current: " << std::setw(3) << game.GetFrame(i).currentScore;
-        ss << ", Total: " << std::setw(3) << game.GetFrame(i).totalScore << "\n";
-        if (i == currentFrameIndex) {
-            ss << std::string(48, '^') << "\n";
+// re-scores an archive across all cores - either a binary roll stream or a text file with one game per line
+static int RunRescore(char const* path, unsigned threadCount) {
+    MappedFile file;
+    if (!file.Map(path)) {
+        std::cerr << "Unable to open " << path << "\n";
+        return 1;
+    }
+
+    std::vector<GameScore> scores;
+    WorkStealingPool pool(threadCount);
+
+    if (RollStreamHeader::HasMagic(file.GetBytes())) {
+        std::optional<RollStreamReader> const reader = RollStreamReader::Open(std::move(file));
+        if (!reader) {
+            std::cerr << "Malformed roll stream " << path << "\n";
+            return 1;
         }
+
+        scores.resize(reader->GetGameCount());
+        RescoreArchive(*reader, scores, pool);
     }
+    else {
+        std::span<const std::uint8_t> const bytes = file.GetBytes();
+        RollSequenceArchive const archive = ReadTextArchive({ reinterpret_cast<char const*>(bytes.data()), bytes.size() });
 
-    return ss.str();
+        scores.resize(archive.GetGameCount());
+        RescoreArchive(archive, scores, pool);
+    }
+
+    GameScoreWriter writer(std::cout);
+    for (GameScore const& score : scores) {
+        writer.Write(score);
+    }
+
+    return 0;
 }
 
-// executes the given bowling game example - strike and spare calls can be replaced with 10s and appropriate numbers, respectively
-consteval Game RunExampleGame() {
-    Game ex;
-    ex.Roll(8); ex.RollSpare();
-    ex.Roll(5); ex.Roll(4);
-    ex.Roll(9); ex.Roll(0);
-    ex.RollStrike();
-    ex.RollStrike();
-    ex.Roll(5); ex.RollSpare();
-    ex.Roll(5); ex.Roll(3);
-    ex.Roll(6); ex.Roll(3);
-    ex.Roll(9); ex.RollSpare();
-    ex.Roll(9); ex.RollSpare(); ex.RollStrike();
+// exports the frames of an archive's complete games to a columnar file, see FrameExport.hpp
+static int RunExport(char const* path, char const* exportPath, unsigned threadCount) {
+    MappedFile file;
+    if (!file.Map(path)) {
+        std::cerr << "Unable to open " << path << "\n";
+        return 1;
+    }
 
-    return ex;
+    std::ofstream out(exportPath, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Unable to write " << exportPath << "\n";
+        return 1;
+    }
+
+    WorkStealingPool pool(threadCount);
+    bool isWritten = false;
+    if (RollStreamHeader::HasMagic(file.GetBytes())) {
+        std::optional<RollStreamReader> const reader = RollStreamReader::Open(std::move(file));
+        if (!reader) {
+            std::cerr << "Malformed roll stream " << path << "\n";
+            return 1;
+        }
+
+        isWritten = ExportArchiveFrames(*reader, out, pool);
+    }
+    else {
+        std::span<const std::uint8_t> const bytes = file.GetBytes();
+        RollSequenceArchive const archive = ReadTextArchive({ reinterpret_cast<char const*>(bytes.data()), bytes.size() });
+        isWritten = ExportArchiveFrames(archive, out, pool);
+    }
+
+    if (!isWritten || !out.flush()) {
+        std::cerr << "Unable to write " << exportPath << "\n";
+        return 1;
+    }
+
+    return 0;
 }
 
-int main() {
-    std::cout << "=== Example game ===\n";
-    constexpr Game ex = RunExampleGame();
-    std::cout << FormatScore(ex) << "\n";
+// converts a text archive into a binary roll stream
+static int RunPack(char const* textPath, char const* streamPath) {
+    MappedFile file;
+    if (!file.Map(textPath)) {
+        std::cerr << "Unable to open " << textPath << "\n";
+        return 1;
+    }
 
-    std::cout << "=== Main game ===\n";
-    std::cout << "Type 'q' to quit the game.\n";
-    std::cout << "Type 'r' to reset the game.\n";
-    std::cout << "Type a number 0-9 to bowl. x for strike, / for spare.\n";
+    std::span<const std::uint8_t> const bytes = file.GetBytes();
+    RollSequenceArchive const archive = ReadTextArchive({ reinterpret_cast<char const*>(bytes.data()), bytes.size() });
 
-    Game game;
-    while (true) {
-        std::cout << "\n" << FormatScore(game) << "\n";
-        if (game.IsGameComplete()) {
-            std::cout << "\n=== Game complete. Starting a new one. ===\n";
-            game = Game();
-            continue;
+    std::ofstream out(streamPath, std::ios::binary | std::ios::trunc);
+    if (!out || !WriteRollStream(out, archive)) {
+        std::cerr << "Unable to write " << streamPath << "\n";
+        return 1;
+    }
+
+    return 0;
+}
+
+// scores games piped through stdin, one per line, printing a result line for each
+//-- stdin is read in large blocks and tokenized in place, without rendering any boards
+static int RunStream() {
+    StreamScorer scorer;
+    GameScoreWriter writer(std::cout);
+    auto const onGame = [&](GameScore const& score) { writer.Write(score); };
+
+    std::array<char, 1u << 16u> block;
+    for (size_t count = std::fread(block.data(), 1u, block.size(), stdin); count > 0u; count = std::fread(block.data(), 1u, block.size(), stdin)) {
+        scorer.Feed(std::span(block).first(count), onGame);
+    }
+    scorer.Finish(onGame);
+
+    return 0;
+}
+
+// walks one subtree of games on an engine, printing what it found
+template <class PlayedGame>
+static bool RunValidationWalk(char const* name, std::span<const std::uint8_t> prefix, ScoreDistribution<> const* expectedScores) {
+    typename GameValidator<PlayedGame>::Report const report = GameValidator<PlayedGame>::Walk(prefix);
+    bool const isValid = report.mismatches == 0u && (expectedScores == nullptr || report.scores == *expectedScores);
+    std::cout << name << ": " << report.games << " games, " << report.rolls << " rolls, " << report.mismatches << " mismatches"
+        << (isValid ? "\n" : ", FAILED\n");
+
+    return isValid;
+}
+
+// checks every way the last frames of a game can be played on both engines, for use as a build step
+//-- the frames before are all gutters, all strikes or all spares, and the gutter games must match the counted distribution
+static int RunValidate(unsigned frames) {
+    unsigned const leadFrames = Game::FinalFrame - std::clamp(frames, 1u, Game::FinalFrame);
+    std::vector<std::uint8_t> const gutters(leadFrames * 2u, 0u);
+    std::vector<std::uint8_t> const strikes(leadFrames, Game::NumPins);
+    std::vector<std::uint8_t> const spares(leadFrames * 2u, Game::NumPins / 2u);
+    ScoreDistribution<> const expectedScores = CountGames(leadFrames);
+
+    bool isValid = true;
+    isValid &= RunValidationWalk<Game>("gutters", gutters, &expectedScores);
+    isValid &= RunValidationWalk<Game>("strikes", strikes, nullptr);
+    isValid &= RunValidationWalk<Game>("spares", spares, nullptr);
+    isValid &= RunValidationWalk<TableGame>("gutters, table scoring", gutters, &expectedScores);
+    isValid &= RunValidationWalk<TableGame>("strikes, table scoring", strikes, nullptr);
+    isValid &= RunValidationWalk<TableGame>("spares, table scoring", spares, nullptr);
+
+    return isValid ? 0 : 1;
+}
+
+// prints how many legal games end on each score, counting the games that start with gutters before the last frames
+static int RunDistribution(unsigned frames) {
+    ScoreDistribution<> const scores = CountGames(Game::FinalFrame - std::clamp(frames, 1u, Game::FinalFrame));
+    std::uint64_t games = 0u;
+    for (size_t score = 0u; score < scores.size(); score++) {
+        if (scores[score] != 0u) {
+            std::cout << score << " " << scores[score] << "\n";
         }
+        games += scores[score];
+    }
+    std::cout << "total " << games << "\n";
+
+    return 0;
+}
+
+// writes a roll sequence as pin counts separated by spaces, the way text archives take them
+static void WriteRolls(std::ostream& out, FuzzRolls const& rolls) {
+    for (size_t i = 0u; i < rolls.count; i++) {
+        out << (i > 0u ? " " : "") << unsigned{ rolls.pins[i] };
+    }
+}
+
+// runs random and adversarial roll sequences through every engine side by side, printing minimized repros of any divergence
+static int RunDifferential(std::uint64_t sequences, std::uint64_t seed, unsigned threadCount) {
+    WorkStealingPool pool(threadCount);
+    DifferentialTester tester(pool);
+
+    auto const start = std::chrono::steady_clock::now();
+    DifferentialReport const report = tester.Run(sequences, seed);
+    double const seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
 
+    std::cout << std::format("{} sequences, {} rolls, {} divergences in {:.2f}s ({:.2f}M sequences/s) with seed {}\n", report.sequences,
+        report.rolls, report.divergences, seconds, static_cast<double>(report.sequences) / seconds / 1e6, seed);
+    for (Divergence const& divergence : report.GetDivergences()) {
+        std::cout << GetCheckName(divergence.check) << " at sequence " << divergence.sequence << ": ";
+        WriteRolls(std::cout, divergence.minimized);
+        std::cout << " (from ";
+        WriteRolls(std::cout, divergence.rolls);
+        std::cout << ")\n";
+    }
+
+    return report.divergences == 0u ? 0 : 1;
+}
+
+// raised by Ctrl+C to stop the scoring server between batches
+static std::atomic<bool> serveStopRequested = false;
+
+// serves every lane of the center to pinsetter controllers over UDP until interrupted
+static int RunServe(std::uint16_t port) {
+    using Service = ScoringService<>;
+    auto const lanes = std::make_unique<Service::Lanes>();
+    auto const service = std::make_unique<Service>(*lanes);
+    ScoringServer<Service> server(*service);
+    if (!server.Open(port)) {
+        std::cerr << "Failed to listen on UDP port " << port << "\n";
+        return 1;
+    }
+
+    std::signal(SIGINT, [](int) { serveStopRequested = true; });
+    std::cout << "Serving " << Service::Lanes::Lanes << " lanes on UDP port " << server.GetPort() << std::endl; // flushed, so scripts can read the port
+    server.Run(serveStopRequested);
+    std::cout << "Applied " << service->GetProcessedCommands() << " commands from " << server.GetReceivedDatagrams() << " datagrams\n";
+
+    return 0;
+}
+
+// the console's boards before the first roll, rendered at compile time
+//-- the interactive board carries on from the empty one, so its first redraw only rewrites what a roll changed
+static constexpr ScoreBoard ExampleBoard = [] {
+    ScoreBoard board;
+    board.Update(RunExampleGame());
+    return board;
+}();
+static constexpr ScoreBoard EmptyBoard = [] {
+    ScoreBoard board;
+    board.Update(Game{});
+    return board;
+}();
+
+// everything the console prints before it first waits for input, optionally leading with the example game
+constexpr std::string MakeStartupText(bool showExample) {
+    std::string text;
+    if (showExample) {
+        text += "=== Example game ===\n";
+        text += ExampleBoard.GetText();
+        text += "\n";
+    }
+    text += "=== Main game ===\n";
+    text += "Type 'q' to quit the game.\n";
+    text += "Type 'r' to reset the game.\n";
+    text += "Type a number 0-9 to bowl. x for strike, / for spare.\n";
+    text += "\n";
+    text += EmptyBoard.GetText();
+    text += "\n";
+
+    return text;
+}
+
+// the startup text as static storage, so printing it is a single write
+template <bool ShowExample>
+static constexpr auto StartupText = [] {
+    std::array<char, MakeStartupText(ShowExample).size()> text{};
+    std::ranges::copy(MakeStartupText(ShowExample), text.begin());
+    return text;
+}();
+
+// plays games typed in one roll at a time, after showing the example game unless told not to
+static int RunInteractiveGame(bool showExample) {
+    std::span<const char> const startupText = showExample ? std::span<const char>(StartupText<true>) : std::span<const char>(StartupText<false>);
+    std::cout.write(startupText.data(), static_cast<std::streamsize>(startupText.size()));
+
+    Game game;
+    ScoreBoard board = EmptyBoard;
+    while (true) {
         std::string s;
         std::cin >> s;
 
@@ -113,28 +1012,133 @@ int main() {
 
         if (s == "r" || s == "reset" || s == "restart") {
             game = Game();
-            continue;
         }
-
-        if (s == "x") {
+        else if (s == "x") {
             std::cout << game.RollStrike().value_or("") << "\n";
-            continue;
         }
-
-        if (s == "/") {
+        else if (s == "/") {
             std::cout << game.RollSpare().value_or("") << "\n";
-            continue;
         }
-
-        if (std::isdigit(s[0])) {
+        else if (std::isdigit(s[0])) {
             std::cout << game.Roll(std::stoul(s)).value_or("") << "\n";
-            continue;
+        }
+        else {
+            std::cout << "Invalid input\n";
+        }
+
+        std::cout << "\n" << board.Update(game) << "\n";
+        if (game.IsGameComplete()) {
+            std::cout << "\n=== Game complete. Starting a new one. ===\n";
+            game = Game();
+            std::cout << "\n" << board.Update(game) << "\n";
+        }
+    }
+
+    std::cout << "\n" << board.Update(game) << "\n";
+
+    return 0;
+}
+
+// picks the mode from the command line
+//-- maybe unused, as nothing calls it when EXPERIS_LIBFUZZER replaces main() with the fuzzer's entry point
+[[maybe_unused]] static int RunMode(std::span<char*> args) {
+    if (args.size() >= 3u && std::string_view(args[1]) == "--rescore") {
+        unsigned threadCount = std::thread::hardware_concurrency();
+        if (args.size() >= 5u && std::string_view(args[3]) == "--threads") {
+            threadCount = static_cast<unsigned>(std::strtoul(args[4], nullptr, 10));
+        }
+
+        return RunRescore(args[2], threadCount);
+    }
+    if (args.size() == 2u && std::string_view(args[1]) == "--stream") {
+        return RunStream();
+    }
+    if (args.size() >= 4u && std::string_view(args[1]) == "--export") {
+        unsigned threadCount = std::thread::hardware_concurrency();
+        if (args.size() >= 6u && std::string_view(args[4]) == "--threads") {
+            threadCount = static_cast<unsigned>(std::strtoul(args[5], nullptr, 10));
+        }
+
+        return RunExport(args[2], args[3], threadCount);
+    }
+    if (args.size() == 4u && std::string_view(args[1]) == "--pack") {
+        return RunPack(args[2], args[3]);
+    }
+    if (args.size() >= 2u && (std::string_view(args[1]) == "--validate" || std::string_view(args[1]) == "--distribution")) {
+        bool const isValidate = std::string_view(args[1]) == "--validate";
+        unsigned frames = isValidate ? 3u : Game::FinalFrame;
+        if (args.size() >= 4u && std::string_view(args[2]) == "--frames") {
+            frames = static_cast<unsigned>(std::strtoul(args[3], nullptr, 10));
         }
 
-        std::cout << "Invalid input\n";
+        return isValidate ? RunValidate(frames) : RunDistribution(frames);
+    }
+    if (args.size() >= 2u && std::string_view(args[1]) == "--diff") {
+        std::uint64_t sequences = 10'000'000u;
+        std::uint64_t seed = static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+        unsigned threadCount = std::thread::hardware_concurrency();
+        for (size_t i = 2u; i + 1u < args.size(); i += 2u) {
+            std::string_view const option = args[i];
+            std::uint64_t const value = std::strtoull(args[i + 1u], nullptr, 10);
+            sequences = option == "--sequences" ? value : sequences;
+            seed = option == "--seed" ? value : seed;
+            threadCount = option == "--threads" ? static_cast<unsigned>(value) : threadCount;
+        }
+
+        return RunDifferential(sequences, seed, threadCount);
+    }
+    if (args.size() == 3u && std::string_view(args[1]) == "--serve") {
+        // a port that isn't all digits or doesn't fit in 16 bits gets the usage instead
+        std::string_view const text = args[2];
+        std::uint16_t port = 0u;
+        std::from_chars_result const parsed = std::from_chars(text.data(), text.data() + text.size(), port);
+        if (parsed.ec == std::errc() && parsed.ptr == text.data() + text.size()) {
+            return RunServe(port);
+        }
+    }
+    if (args.size() == 2u && std::string_view(args[1]) == "--no-example") {
+        return RunInteractiveGame(false);
+    }
+    if (args.size() > 1u) {
+        std::cerr << "Usage: " << args[0] << " [--no-example]\n";
+        std::cerr << "       " << args[0] << " [--rescore <games.txt|games.ebrs> [--threads <count>]]\n";
+        std::cerr << "       " << args[0] << " [--export <games.txt|games.ebrs> <frames.ebfx> [--threads <count>]]\n";
+        std::cerr << "       " << args[0] << " [--pack <games.txt> <games.ebrs>]\n";
+        std::cerr << "       " << args[0] << " [--stream] < games.txt\n";
+        std::cerr << "       " << args[0] << " [--validate [--frames <count>]]\n";
+        std::cerr << "       " << args[0] << " [--distribution [--frames <count>]]\n";
+        std::cerr << "       " << args[0] << " [--diff [--sequences <count>] [--seed <seed>] [--threads <count>]]\n";
+        std::cerr << "       " << args[0] << " [--serve <udp port>]\n";
+        return 1;
     }
 
-    std::cout << "\n" << FormatScore(game) << "\n";
+    return RunInteractiveGame(true);
+}
+
+#if defined(EXPERIS_LIBFUZZER)
+// entry point for a coverage-guided fuzzer in place of main(), e.g. clang++ -fsanitize=fuzzer -DEXPERIS_LIBFUZZER
+//-- every input decodes to a roll sequence, and a divergence aborts with its minimized repro
+extern "C" int LLVMFuzzerTestOneInput(std::uint8_t const* data, size_t size) {
+    FuzzRolls const rolls = RollSequenceFuzzer::Decode({ data, size });
+    if (DifferentialCheck const check = CheckEveryEngine(rolls); check != DifferentialCheck::None) {
+        std::cerr << GetCheckName(check) << ": ";
+        WriteRolls(std::cerr, MinimizeFailure(rolls, check));
+        std::cerr << std::endl;
+        std::abort();
+    }
 
     return 0;
-}
\ No newline at end of file
+}
+#else
+int main(int argc, char* argv[]) {
+    // nothing writes through C stdio, so iostreams can buffer on their own
+    std::ios::sync_with_stdio(false);
+
+    int const status = RunMode(std::span(argv, static_cast<size_t>(argc)));
+    if constexpr (Metrics::IsEnabled()) {
+        Metrics::Dump(std::cerr);
+    }
+
+    return status;
+}
+#endif
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ExperisBowling {
+    // Read-only memory mapping of a whole file, unmapped when destroyed.
+    class MappedFile {
+    private:
+        std::uint8_t const* data = nullptr;
+        size_t              size = 0u;
+
+    public:
+        MappedFile() = default;
+
+        MappedFile(MappedFile&& other) noexcept
+            : data(std::exchange(other.data, nullptr))
+            , size(std::exchange(other.size, 0u)) {
+        }
+
+        MappedFile& operator=(MappedFile&& other) noexcept {
+            if (this != &other) {
+                Unmap();
+                data = std::exchange(other.data, nullptr);
+                size = std::exchange(other.size, 0u);
+            }
+
+            return *this;
+        }
+
+        ~MappedFile() {
+            Unmap();
+        }
+
+        // maps the file at the given path, returning false if it can't be opened
+        //-- an empty file maps successfully to an empty view
+        bool Map(char const* path) {
+            Unmap();
+
+#if defined(_WIN32)
+            HANDLE const file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (file == INVALID_HANDLE_VALUE) {
+                return false;
+            }
+
+            LARGE_INTEGER fileSize;
+            bool isMapped = GetFileSizeEx(file, &fileSize) != 0;
+            if (isMapped && fileSize.QuadPart > 0) {
+                HANDLE const mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                void const* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+                if (mapping) {
+                    CloseHandle(mapping); // the view keeps the mapping alive
+                }
+
+                isMapped = view != nullptr;
+                data = static_cast<std::uint8_t const*>(view);
+                size = isMapped ? static_cast<size_t>(fileSize.QuadPart) : 0u;
+            }
+            CloseHandle(file);
+
+            return isMapped;
+#else
+            int const file = open(path, O_RDONLY);
+            if (file < 0) {
+                return false;
+            }
+
+            struct stat fileStats;
+            bool isMapped = fstat(file, &fileStats) == 0;
+            if (isMapped && fileStats.st_size > 0) {
+                void* const view = mmap(nullptr, static_cast<size_t>(fileStats.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+                isMapped = view != MAP_FAILED;
+                if (isMapped) {
+                    madvise(view, static_cast<size_t>(fileStats.st_size), MADV_SEQUENTIAL);
+                    data = static_cast<std::uint8_t const*>(view);
+                    size = static_cast<size_t>(fileStats.st_size);
+                }
+            }
+            close(file); // the mapping stays valid after the descriptor is closed
+
+            return isMapped;
+#endif
+        }
+
+        std::span<const std::uint8_t> GetBytes() const {
+            return { data, size };
+        }
+
+    private:
+        void Unmap() {
+            if (data) {
+#if defined(_WIN32)
+                UnmapViewOfFile(data);
+#else
+                munmap(const_cast<std::uint8_t*>(data), size);
+#endif
+            }
+
+            data = nullptr;
+            size = 0u;
+        }
+    };
+} // namespace ExperisBowling
@@ -0,0 +1,212 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include "Game.hpp"
+#include "GameRules.hpp"
+#include "GameValidation.hpp"
+#include <span>
+#include <vector>
+#include "WorkStealingPool.hpp"
+
+namespace ExperisBowling {
+    // SplitMix64 - a full 64-bit state advanced by one add, cheap enough to give every block of rollouts its own
+    struct SimulationRng {
+        std::uint64_t   state   = 0u;
+
+        constexpr std::uint64_t Next() {
+            std::uint64_t value = state += 0x9e3779b97f4a7c15u;
+            value = (value ^ (value >> 30u)) * 0xbf58476d1ce4e5b9u;
+            value = (value ^ (value >> 27u)) * 0x94d049bb133111ebu;
+            return value ^ (value >> 31u);
+        }
+    };
+
+    // How a bowler tends to roll, as counts of how many pins they knocked down from every number left standing.
+    //-- built up from the bowler's past rolls; pin counts nothing has been seen for are treated as equally likely
+    template <GameRules Rules = TenPinRules>
+    class RollModel {
+    public:
+        static constexpr unsigned NumPins = Rules::NumPins;
+
+    private:
+        std::array<std::array<std::uint32_t, NumPins + 1u>, NumPins + 1u>  counts  = {};   // [standing pins][pins knocked down]
+
+    public:
+        constexpr void Observe(unsigned standingPins, unsigned pinCount, std::uint32_t weight = 1u) {
+            if (pinCount <= standingPins && standingPins <= NumPins) {
+                counts[standingPins][pinCount] += weight;
+            }
+        }
+
+        // observes every roll of a game, returning false if the rolls aren't a legal game
+        constexpr bool ObserveGame(std::span<const std::uint8_t> rolls) {
+            BasicGame<Rules> game;
+            for (std::uint8_t const pinCount : rolls) {
+                unsigned const standingPins = game.GetStandingPins();
+                if (!game.TryRoll(pinCount)) {
+                    return false;
+                }
+                Observe(standingPins, pinCount);
+            }
+
+            return true;
+        }
+
+        constexpr std::span<const std::uint32_t> GetCounts(unsigned standingPins) const {
+            return std::span(counts[standingPins]).first(standingPins + 1u);
+        }
+    };
+
+    // Draws pin counts from a RollModel, by way of cumulative thresholds over 32-bit random numbers.
+    template <GameRules Rules = TenPinRules>
+    class RollSampler {
+    public:
+        static constexpr unsigned NumPins = Rules::NumPins;
+
+    private:
+        // a pin count is drawn if the random number is below its threshold and not the one before
+        //-- the last pin count of each row takes whatever is left, so it has no threshold of its own
+        std::array<std::array<std::uint32_t, NumPins>, NumPins + 1u>   thresholds  = {};
+
+    public:
+        constexpr explicit RollSampler(RollModel<Rules> const& model) {
+            for (unsigned standingPins = 1u; standingPins <= NumPins; standingPins++) {
+                std::span<const std::uint32_t> const counts = model.GetCounts(standingPins);
+                std::uint64_t total = 0u;
+                for (std::uint32_t const count : counts) {
+                    total += count;
+                }
+
+                std::uint64_t seen = 0u;
+                for (unsigned pinCount = 0u; pinCount < standingPins; pinCount++) {
+                    seen += total > 0u ? counts[pinCount] : 1u;
+                    std::uint64_t const outOf = total > 0u ? total : standingPins + 1u;
+                    thresholds[standingPins][pinCount] = static_cast<std::uint32_t>(std::min<std::uint64_t>((seen << 32u) / outOf, UINT32_MAX));
+                }
+            }
+        }
+
+        constexpr unsigned Sample(unsigned standingPins, std::uint32_t random) const {
+            std::array<std::uint32_t, NumPins> const& row = thresholds[standingPins];
+            for (unsigned pinCount = 0u; pinCount < standingPins; pinCount++) {
+                if (random < row[pinCount]) {
+                    return pinCount;
+                }
+            }
+
+            return standingPins;
+        }
+    };
+
+    // Estimates how games in progress will finish, by playing the rest of them out many times from their current state.
+    //-- rollouts run in fixed blocks across the pool, each block with its own generator seeded from the query's seed and
+    //-- its index, so a query gives the same answer however many threads run it
+    //-- a rollout never copies or changes the game, it plays the remaining rolls out on PlayOutScore()'s few counters
+    template <class PlayedGame = Game>
+    class OutcomeSimulator {
+    public:
+        using Rules = typename PlayedGame::RulesPolicy;
+        using Sampler = RollSampler<Rules>;
+        using Distribution = ScoreDistribution<Rules>;
+
+        static constexpr size_t RolloutsPerBlock = 512u;
+        static constexpr size_t MaxMatchBowlers = 8u;
+
+        // how often each bowler of a match came out on top, with ties shared between everyone tied
+        struct MatchOutcome {
+            std::array<double, MaxMatchBowlers>     winShares   = {};
+            size_t                                  rollouts    = 0u;
+
+            constexpr double GetWinProbability(size_t bowler) const {
+                return rollouts > 0u ? winShares[bowler] / static_cast<double>(rollouts) : 0.0;
+            }
+        };
+
+    private:
+        WorkStealingPool&           pool;
+        std::vector<Distribution>   blockScores;    // kept between queries, so a query only allocates the first time it's this big
+        std::vector<MatchOutcome>   blockOutcomes;
+
+    public:
+        explicit OutcomeSimulator(WorkStealingPool& workerPool)
+            : pool(workerPool) {
+        }
+
+        // plays a game to the end with rolls drawn from the sampler, returning its final score
+        static constexpr unsigned PlayOut(PlayedGame const& game, Sampler const& sampler, SimulationRng& rng) {
+            return game.PlayOutScore([&](unsigned standingPins) { return sampler.Sample(standingPins, static_cast<std::uint32_t>(rng.Next() >> 32u)); });
+        }
+
+        // how many of the rollouts ended on each final score
+        Distribution SimulateScores(PlayedGame const& game, Sampler const& sampler, size_t rollouts, std::uint64_t seed) {
+            size_t const blockCount = (rollouts + RolloutsPerBlock - 1u) / RolloutsPerBlock;
+            blockScores.resize(std::max(blockScores.size(), blockCount));
+
+            pool.ParallelFor(blockCount, [&](size_t block) {
+                Distribution& scores = blockScores[block];
+                scores.fill(0u);
+
+                SimulationRng rng = MakeRng(seed, block);
+                for (size_t i = block * RolloutsPerBlock; i < std::min(rollouts, (block + 1u) * RolloutsPerBlock); i++) {
+                    scores[std::min(PlayOut(game, sampler, rng), ReferenceScorer<Rules>::MaxScore)]++;
+                }
+            });
+
+            Distribution total = {};
+            for (size_t block = 0u; block < blockCount; block++) {
+                for (size_t score = 0u; score < total.size(); score++) {
+                    total[score] += blockScores[block][score];
+                }
+            }
+
+            return total;
+        }
+
+        // how likely each bowler is to finish with the highest score, each playing on with their own sampler
+        //-- matches take up to MaxMatchBowlers bowlers, any more are left out
+        MatchOutcome SimulateMatch(std::span<const PlayedGame> games, std::span<const Sampler> samplers, size_t rollouts, std::uint64_t seed) {
+            size_t const bowlerCount = std::min({ games.size(), samplers.size(), MaxMatchBowlers });
+            size_t const blockCount = (rollouts + RolloutsPerBlock - 1u) / RolloutsPerBlock;
+            blockOutcomes.resize(std::max(blockOutcomes.size(), blockCount));
+
+            pool.ParallelFor(blockCount, [&](size_t block) {
+                MatchOutcome& outcome = blockOutcomes[block];
+                outcome = {};
+
+                SimulationRng rng = MakeRng(seed, block);
+                std::array<unsigned, MaxMatchBowlers> scores{};
+                for (size_t i = block * RolloutsPerBlock; i < std::min(rollouts, (block + 1u) * RolloutsPerBlock); i++) {
+                    unsigned bestScore = 0u;
+                    for (size_t bowler = 0u; bowler < bowlerCount; bowler++) {
+                        scores[bowler] = PlayOut(games[bowler], samplers[bowler], rng);
+                        bestScore = std::max(bestScore, scores[bowler]);
+                    }
+
+                    unsigned const winners = static_cast<unsigned>(std::count(scores.begin(), scores.begin() + bowlerCount, bestScore));
+                    for (size_t bowler = 0u; bowler < bowlerCount; bowler++) {
+                        outcome.winShares[bowler] += scores[bowler] == bestScore ? 1.0 / winners : 0.0;
+                    }
+                    outcome.rollouts++;
+                }
+            });
+
+            MatchOutcome total;
+            for (size_t block = 0u; block < blockCount; block++) {
+                for (size_t bowler = 0u; bowler < bowlerCount; bowler++) {
+                    total.winShares[bowler] += blockOutcomes[block].winShares[bowler];
+                }
+                total.rollouts += blockOutcomes[block].rollouts;
+            }
+
+            return total;
+        }
+
+    private:
+        static constexpr SimulationRng MakeRng(std::uint64_t seed, size_t block) {
+            SimulationRng mixer = { seed ^ (static_cast<std::uint64_t>(block) * 0xd1b54a32d192ed03u) };
+            return { mixer.Next() };
+        }
+    };
+} // namespace ExperisBowling
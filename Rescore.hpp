@@ -0,0 +1,81 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include "Archive.hpp"
+#include "BatchScorer.hpp"
+#include <cstdint>
+#include "Game.hpp"
+#include <span>
+#include "WorkStealingPool.hpp"
+
+namespace ExperisBowling {
+    // the result of re-scoring a single archived game
+    struct GameScore {
+        std::array<std::uint16_t, Game::FinalFrame> frameTotals     = {};
+        std::uint16_t                               finalScore      = 0u;
+        bool                                        isValid         = false;    // false if the rolls don't form a complete, legal game
+    };
+
+    // summarizes a scalar game the same way the pipeline reports archived ones
+    constexpr GameScore ToGameScore(Game const& game) {
+        GameScore score;
+        if (!game.IsGameComplete()) {
+            return score;
+        }
+
+        for (unsigned frame = 0u; frame < Game::FinalFrame; frame++) {
+            score.frameTotals[frame] = static_cast<std::uint16_t>(game.GetFrame(frame).totalScore);
+        }
+        score.finalScore = score.frameTotals[Game::FinalFrame - 1u];
+        score.isValid = true;
+
+        return score;
+    }
+
+    // enough games per chunk to amortize scheduling, small enough for stealing to balance the tail
+    static constexpr size_t DefaultGamesPerChunk = 4096u;
+
+    // re-scores every game in an archive, splitting it into chunks that are run across the pool
+    //-- each chunk goes through the batch kernel one lane group at a time
+    template <GameArchive Archive>
+    void RescoreArchive(Archive const& archive, std::span<GameScore> scores, WorkStealingPool& pool, size_t gamesPerChunk = DefaultGamesPerChunk) {
+        using Scorer = BatchScorer<>;
+
+        size_t const gameCount = std::min(archive.GetGameCount(), scores.size());
+        size_t const chunkCount = (gameCount + gamesPerChunk - 1u) / gamesPerChunk;
+
+        pool.ParallelFor(chunkCount, [&](size_t chunk) {
+            size_t const chunkEnd = std::min(gameCount, (chunk + 1u) * gamesPerChunk);
+            std::array<std::uint8_t, Game::MaxRolls + 1u> buffer;
+            Scorer::Rolls rolls;
+            Scorer::Scores laneScores;
+
+            for (size_t first = chunk * gamesPerChunk; first < chunkEnd; first += Scorer::Lanes) {
+                size_t const laneCount = std::min(Scorer::Lanes, chunkEnd - first);
+                for (size_t lane = 0u; lane < laneCount; lane++) {
+                    rolls.SetGame(lane, archive.GetGameRolls(first + lane, buffer));
+                }
+                for (size_t lane = laneCount; lane < Scorer::Lanes; lane++) {
+                    rolls.SetGame(lane, {});
+                }
+
+                Scorer::Score(rolls, laneScores);
+
+                for (size_t lane = 0u; lane < laneCount; lane++) {
+                    GameScore& score = scores[first + lane];
+                    score = {};
+                    if (laneScores.isValid[lane] == 0u) { // the kernel's scores are meaningless for invalid games
+                        continue;
+                    }
+
+                    for (unsigned frame = 0u; frame < Game::FinalFrame; frame++) {
+                        score.frameTotals[frame] = laneScores.totalScore[frame][lane];
+                    }
+                    score.finalScore = laneScores.totalScore[Game::FinalFrame - 1u][lane];
+                    score.isValid = true;
+                }
+            }
+        });
+    }
+} // namespace ExperisBowling
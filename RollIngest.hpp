@@ -0,0 +1,153 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "Game.hpp"
+#include "Instrumentation.hpp"
+#include "LaneManager.hpp"
+#include <memory>
+#include "RollJournal.hpp"
+#include "Seqlock.hpp"
+#include "SpscRing.hpp"
+#include "WorkStealingPool.hpp"
+
+namespace ExperisBowling {
+    // a roll reported by a lane's pinsetter
+    struct RollEvent {
+        std::uint8_t    bowler      = 0u;   // position in the lane's bowling order
+        std::uint8_t    pinCount    = 0u;
+    };
+
+    // Feeds roll events from every lane's pinsetter into the lane manager's games without any locks.
+    //-- each lane has its own ring with the pinsetter as the only producer and whoever drains that lane as the only consumer,
+    //-- and after draining, the lane's games are published as one snapshot that readers copy without blocking the lane
+    //-- bowlers are added and removed through the lane manager only while their lane isn't being drained
+    //-- with a journal attached, every roll a game accepts is appended to it as the lane drains, and DrainAll() commits
+    //-- them with one sync for all lanes before it returns; a published snapshot can run ahead of the journal until then
+    template <size_t LaneCount = 48u, size_t MaxBowlersPerLane = 6u, size_t RingCapacity = 64u>
+    class RollIngestor {
+    public:
+        using Lanes = LaneManager<LaneCount, MaxBowlersPerLane>;
+
+        // a consistent copy of every game on a lane, as of its latest drain
+        struct LaneSnapshot {
+            std::array<Game, MaxBowlersPerLane>     games           = {};
+            std::uint8_t                            bowlerCount     = 0u;
+        };
+
+    private:
+        static constexpr size_t CacheLineSize = SpscRing<RollEvent, RingCapacity>::CacheLineSize;
+
+        // padded out to whole lines explicitly, since MSVC warns (C4324) about padding an alignment specifier adds
+        //-- the ring already ends on a line, and the rest takes up a whole extra line when it happens to end on one too
+        static constexpr size_t FeedPadding = CacheLineSize - (sizeof(SeqlockCell<LaneSnapshot>) + sizeof(std::atomic<std::uint64_t>)) % CacheLineSize;
+
+        struct alignas(CacheLineSize) LaneFeed {
+            SpscRing<RollEvent, RingCapacity>       events;
+            SeqlockCell<LaneSnapshot>               snapshot;
+            std::atomic<std::uint64_t>              rejectedRolls   = 0u;   // events the games refused, e.g. a roll after the game ended
+            std::array<std::byte, FeedPadding>      padding         = {};
+        };
+        static_assert(sizeof(LaneFeed) % CacheLineSize == 0u);
+
+        Lanes&                          lanes;
+        RollJournal*                    journal;
+        std::unique_ptr<LaneFeed[]>     feeds   = std::make_unique<LaneFeed[]>(LaneCount);
+
+    public:
+        explicit RollIngestor(Lanes& laneManager, RollJournal* rollJournal = nullptr)
+            : lanes(laneManager)
+            , journal(rollJournal) {
+        }
+
+        RollIngestor(RollIngestor const&) = delete;
+        RollIngestor& operator=(RollIngestor const&) = delete;
+
+        // queues a roll from a lane's pinsetter - only one thread may post to each lane
+        //-- returns false if the lane's ring is full, leaving the pinsetter to retry
+        bool Post(size_t lane, RollEvent event) {
+            return lane < LaneCount && feeds[lane].events.TryPush(event);
+        }
+
+        // applies every queued roll on a lane and publishes the result, returning how many rolls the games accepted
+        //-- rolls the games refuse are consumed all the same, and only counted in GetRejectedRolls()
+        //-- only one thread may drain a given lane at a time
+        size_t Drain(size_t lane) {
+            if (lane >= LaneCount) {
+                return 0u;
+            }
+
+            EXPERIS_PROBE_LANE(lane);
+            LaneFeed& feed = feeds[lane];
+            size_t applied = 0u;
+            std::uint64_t rejected = 0u;
+            std::array<RollJournal::Entry, RingCapacity> accepted;
+            size_t acceptedCount = 0u;
+            for (std::optional<RollEvent> event = feed.events.TryPop(); event; event = feed.events.TryPop()) {
+                Game* const game = lanes.GetGame(lane, event->bowler);
+                bool const isAccepted = game != nullptr && game->TryRoll(event->pinCount);
+                rejected += !isAccepted;
+                applied += isAccepted;
+
+                if (isAccepted && journal != nullptr) {
+                    accepted[acceptedCount++] = { *lanes.GetHandle(lane, event->bowler), static_cast<std::uint16_t>(lane), event->pinCount };
+                    if (acceptedCount == accepted.size()) {
+                        journal->Append(accepted);
+                        acceptedCount = 0u;
+                    }
+                }
+            }
+            if (acceptedCount > 0u) {
+                journal->Append(std::span(accepted).first(acceptedCount));
+            }
+
+            if (rejected > 0u) {
+                feed.rejectedRolls.fetch_add(rejected, std::memory_order_relaxed);
+            }
+            if (applied > 0u) { // refused rolls leave the games as they were, so there's nothing new to publish
+                Publish(lane);
+            }
+
+            return applied;
+        }
+
+        // drains every lane across the pool, one lane per task, then commits whatever they journaled
+        //-- whether the commit went through is up to the journal's HasFailed()
+        size_t DrainAll(WorkStealingPool& pool) {
+            std::atomic<size_t> applied = 0u;
+            pool.ParallelFor(LaneCount, [&](size_t lane) { applied.fetch_add(Drain(lane), std::memory_order_relaxed); });
+            if (journal != nullptr) {
+                journal->Commit();
+            }
+
+            return applied.load(std::memory_order_relaxed);
+        }
+
+        // republishes a lane after its bowlers changed outside of ingestion, from the thread that drains it
+        void Publish(size_t lane) {
+            LaneSnapshot snapshot;
+            snapshot.bowlerCount = static_cast<std::uint8_t>(lanes.GetBowlerCount(lane));
+            for (size_t i = 0u; i < snapshot.bowlerCount; i++) {
+                snapshot.games[i] = *lanes.GetGame(lane, i);
+            }
+
+            feeds[lane].snapshot.Store(snapshot);
+        }
+
+        // copies out a lane's latest published games, safe to call from any thread at any time
+        LaneSnapshot ReadSnapshot(size_t lane) const {
+            return lane < LaneCount ? feeds[lane].snapshot.Load() : LaneSnapshot{};
+        }
+
+        // how many times a lane has been published, so readers can skip redrawing a lane that hasn't changed
+        std::uint64_t GetSnapshotVersion(size_t lane) const {
+            return lane < LaneCount ? feeds[lane].snapshot.GetVersion() : 0u;
+        }
+
+        std::uint64_t GetRejectedRolls(size_t lane) const {
+            return lane < LaneCount ? feeds[lane].rejectedRolls.load(std::memory_order_relaxed) : 0u;
+        }
+    };
+} // namespace ExperisBowling
@@ -0,0 +1,431 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <condition_variable>
+#include "Crc32.hpp"
+#include <cstddef>
+#include <cstdint>
+#include "Game.hpp"
+#include "GamePool.hpp"
+#include "MappedFile.hpp"
+#include <mutex>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace ExperisBowling {
+    // Layout of a roll journal, little-endian throughout:
+    //   header  - JournalHeader::Size bytes: magic and format version
+    //   records - JournalRecord::Size bytes each, one per accepted roll in sequence order, each with its own checksum
+    // a crash can leave the last records torn, so a journal is read up to its first damaged record and no further
+    struct JournalHeader {
+        static constexpr std::array<std::uint8_t, 4u>   Magic           = { 'E', 'B', 'R', 'J' };
+        static constexpr std::uint16_t                  CurrentVersion  = 1u;
+        static constexpr size_t                         Size            = 8u;
+
+        // byte offsets of each field - bytes 6 and 7 are reserved
+        static constexpr size_t VersionOffset = 4u;
+
+        static constexpr std::array<std::uint8_t, Size> Encode() {
+            std::array<std::uint8_t, Size> bytes{};
+            std::copy(Magic.begin(), Magic.end(), bytes.begin());
+            bytes[VersionOffset] = static_cast<std::uint8_t>(CurrentVersion);
+            bytes[VersionOffset + 1u] = static_cast<std::uint8_t>(CurrentVersion >> 8u);
+
+            return bytes;
+        }
+
+        static constexpr bool IsJournal(std::span<const std::uint8_t> bytes) {
+            std::array<std::uint8_t, Size> const header = Encode();
+            return bytes.size() >= Size && std::equal(header.begin(), header.begin() + VersionOffset + 2u, bytes.begin());
+        }
+    };
+
+    // one accepted roll, as journaled
+    struct JournalRecord {
+        static constexpr size_t Size = 24u;
+
+        std::uint64_t   sequence    = 0u;   // counts up from 1 across every lane, one per roll
+        GameHandle      game;
+        std::uint16_t   lane        = 0u;
+        std::uint8_t    pinCount    = 0u;
+
+        // byte offsets of each field - byte 19 is reserved, and the checksum covers every byte before it
+        static constexpr size_t SequenceOffset = 0u;
+        static constexpr size_t GameIndexOffset = 8u;
+        static constexpr size_t GameGenerationOffset = 12u;
+        static constexpr size_t LaneOffset = 16u;
+        static constexpr size_t PinCountOffset = 18u;
+        static constexpr size_t ChecksumOffset = 20u;
+
+        template <class T>
+        static constexpr T LoadLittleEndian(std::uint8_t const* bytes) {
+            T value = 0u;
+            for (size_t i = 0u; i < sizeof(T); i++) {
+                value |= static_cast<T>(static_cast<T>(bytes[i]) << (8u * i));
+            }
+
+            return value;
+        }
+
+        template <class T>
+        static constexpr void StoreLittleEndian(std::uint8_t* bytes, T value) {
+            for (size_t i = 0u; i < sizeof(T); i++) {
+                bytes[i] = static_cast<std::uint8_t>(value >> (8u * i));
+            }
+        }
+
+        constexpr void Encode(std::uint8_t* bytes) const {
+            StoreLittleEndian(bytes + SequenceOffset, sequence);
+            StoreLittleEndian(bytes + GameIndexOffset, game.index);
+            StoreLittleEndian(bytes + GameGenerationOffset, game.generation);
+            StoreLittleEndian(bytes + LaneOffset, lane);
+            bytes[PinCountOffset] = pinCount;
+            bytes[PinCountOffset + 1u] = 0u;
+            StoreLittleEndian(bytes + ChecksumOffset, GetChecksum(bytes));
+        }
+
+        // reads a record, returning nothing if it was torn or damaged
+        static constexpr std::optional<JournalRecord> Decode(std::uint8_t const* bytes) {
+            if (LoadLittleEndian<std::uint32_t>(bytes + ChecksumOffset) != GetChecksum(bytes)) {
+                return std::nullopt;
+            }
+
+            JournalRecord record;
+            record.sequence = LoadLittleEndian<std::uint64_t>(bytes + SequenceOffset);
+            record.game.index = LoadLittleEndian<std::uint32_t>(bytes + GameIndexOffset);
+            record.game.generation = LoadLittleEndian<std::uint32_t>(bytes + GameGenerationOffset);
+            record.lane = LoadLittleEndian<std::uint16_t>(bytes + LaneOffset);
+            record.pinCount = bytes[PinCountOffset];
+
+            return record;
+        }
+
+        static constexpr std::uint32_t GetChecksum(std::uint8_t const* bytes) {
+            return Crc32c().Update(std::span(bytes, ChecksumOffset)).Get();
+        }
+    };
+
+    // how much of a journal could be read
+    struct JournalScan {
+        size_t          intactSize      = 0u;   // bytes up to the end of the last intact record
+        size_t          records         = 0u;
+        std::uint64_t   lastSequence    = 0u;   // 0 for a journal without records
+        bool            isJournal       = false;
+    };
+
+    // calls body(record) for every intact record of a journal, stopping at the first torn, damaged or out-of-order one
+    template <class Body>
+    constexpr JournalScan ScanJournal(std::span<const std::uint8_t> bytes, Body&& body) {
+        JournalScan scan;
+        scan.isJournal = JournalHeader::IsJournal(bytes);
+        if (!scan.isJournal) {
+            return scan;
+        }
+
+        scan.intactSize = JournalHeader::Size;
+        for (; bytes.size() - scan.intactSize >= JournalRecord::Size; scan.intactSize += JournalRecord::Size) {
+            std::optional<JournalRecord> const record = JournalRecord::Decode(bytes.data() + scan.intactSize);
+            if (!record || record->sequence <= scan.lastSequence) {
+                break;
+            }
+
+            body(*record);
+            scan.lastSequence = record->sequence;
+            scan.records++;
+        }
+
+        return scan;
+    }
+
+    // what replaying a journal did
+    struct JournalReplay {
+        size_t          replayedRolls   = 0u;
+        size_t          rejectedRolls   = 0u;   // rolls the games refused, which means the snapshot and journal don't match
+        size_t          unknownRolls    = 0u;   // rolls for games that weren't in the snapshot
+        size_t          games           = 0u;   // games that had rolls replayed onto them
+        std::uint64_t   lastSequence    = 0u;   // the sequence the games are now caught up to
+    };
+
+    // Brings games restored from a snapshot up to date with every roll journaled after it.
+    //-- findGame(record) returns the game a record's roll belongs to, or nullptr if the snapshot didn't have it
+    //-- each game's rolls are gathered first and replayed in one ScoreRolls() pass behind the rolls it already has,
+    //-- instead of one Roll() call per journaled roll
+    template <class FindGame>
+    constexpr JournalReplay ReplayJournal(std::span<const std::uint8_t> bytes, std::uint64_t snapshotSequence, FindGame&& findGame) {
+        std::vector<JournalRecord> records;
+        JournalReplay replay;
+        replay.lastSequence = ScanJournal(bytes, [&](JournalRecord const& record) {
+            if (record.sequence > snapshotSequence) {
+                records.push_back(record);
+            }
+        }).lastSequence;
+        replay.lastSequence = std::max(replay.lastSequence, snapshotSequence);
+
+        // group the rolls by game, each game's still in the order they were played
+        std::sort(records.begin(), records.end(), [](JournalRecord const& record, JournalRecord const& other) {
+            return std::pair(record.game.index, record.game.generation) != std::pair(other.game.index, other.game.generation)
+                ? std::pair(record.game.index, record.game.generation) < std::pair(other.game.index, other.game.generation)
+                : record.sequence < other.sequence;
+        });
+
+        std::array<std::uint8_t, Game::MaxRolls + 1u> rolls{}; // one extra, so a game journaled past its end is rejected
+        for (size_t first = 0u, last = 0u; first < records.size(); first = last) {
+            while (last < records.size() && records[last].game == records[first].game) {
+                last++;
+            }
+
+            Game* const game = findGame(records[first]);
+            if (game == nullptr) {
+                replay.unknownRolls += last - first;
+                continue;
+            }
+
+            size_t rollCount = game->GetRollCount();
+            for (size_t i = 0u; i < rollCount; i++) {
+                rolls[i] = static_cast<std::uint8_t>(game->GetLoggedRoll(static_cast<unsigned>(i)));
+            }
+            size_t const journaledRolls = std::min(last - first, rolls.size() - rollCount);
+            for (size_t i = 0u; i < journaledRolls; i++) {
+                rolls[rollCount++] = records[first + i].pinCount;
+            }
+
+            size_t const playedRolls = game->GetRollCount();
+            game->ScoreRolls(std::span(rolls).first(rollCount));
+            size_t const acceptedRolls = game->GetRollCount() - std::min<size_t>(playedRolls, game->GetRollCount());
+            replay.replayedRolls += acceptedRolls;
+            replay.rejectedRolls += last - first - acceptedRolls;
+            replay.games++;
+        }
+
+        return replay;
+    }
+
+    // Append-only journal of accepted rolls, made durable by group commit.
+    //-- any number of threads append rolls, which only copies them into a shared buffer under a lock
+    //-- a thread that needs its rolls durable calls Commit(): the first one in writes out everything appended
+    //-- so far and syncs it once, while the rest wait on that sync instead of each issuing their own, so one
+    //-- sync covers every lane that appended since the last one
+    //-- only rolls are journaled, so anything else that changes a game, such as resetting it, should be
+    //-- followed by a fresh snapshot
+    class RollJournal {
+    public:
+        // an accepted roll, before it's given a sequence
+        struct Entry {
+            GameHandle      game;
+            std::uint16_t   lane        = 0u;
+            std::uint8_t    pinCount    = 0u;
+        };
+
+    private:
+#if defined(_WIN32)
+        using File = HANDLE;
+        static inline File const NoFile = INVALID_HANDLE_VALUE;
+#else
+        using File = int;
+        static constexpr File NoFile = -1;
+#endif
+
+        File                        file            = NoFile;
+        mutable std::mutex          mutex;
+        std::condition_variable     synced;
+        std::vector<std::uint8_t>   pending;                // encoded records waiting for the next sync
+        std::vector<std::uint8_t>   writing;                // the records being synced, only touched by the thread syncing them
+        std::uint64_t               lastSequence    = 0u;   // given to the latest appended roll
+        std::uint64_t               durableSequence = 0u;   // every roll up to this one has been synced
+        std::uint64_t               syncs           = 0u;
+        bool                        isSyncing       = false;
+        bool                        hasFailed       = false;
+
+    public:
+        RollJournal() = default;
+
+        RollJournal(RollJournal const&) = delete;
+        RollJournal& operator=(RollJournal const&) = delete;
+
+        ~RollJournal() {
+            Close();
+        }
+
+        // opens the journal at the given path for appending, creating it if it doesn't exist
+        //-- an existing journal is kept up to its last intact record, cutting off anything a crash left torn after it,
+        //-- and its sequence carries on from there; returns false for files that aren't journals
+        bool Open(char const* path) {
+            Close();
+
+            JournalScan scan;
+            {
+                MappedFile existing;
+                if (existing.Map(path)) {
+                    scan = ScanJournal(existing.GetBytes(), [](JournalRecord const&) {});
+                    if (!scan.isJournal && existing.GetBytes().size() >= JournalHeader::Size) {
+                        return false;
+                    }
+                }
+            }
+
+#if defined(_WIN32)
+            file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+            LARGE_INTEGER end;
+            end.QuadPart = static_cast<LONGLONG>(scan.intactSize);
+            bool const isOpen = file != NoFile && SetFilePointerEx(file, end, nullptr, FILE_BEGIN) != 0 && SetEndOfFile(file) != 0;
+#else
+            file = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+            bool const isOpen = file != NoFile && ftruncate(file, static_cast<off_t>(scan.intactSize)) == 0
+                && lseek(file, 0, SEEK_END) == static_cast<off_t>(scan.intactSize);
+#endif
+            std::array<std::uint8_t, JournalHeader::Size> const header = JournalHeader::Encode();
+            if (!isOpen || (scan.intactSize == 0u && !WriteAndSync(header))) {
+                Close();
+                return false;
+            }
+
+            lastSequence = scan.lastSequence;
+            durableSequence = scan.lastSequence;
+            syncs = 0u;
+            hasFailed = false;
+
+            return true;
+        }
+
+        // commits every appended roll and closes the journal
+        void Close() {
+            if (file == NoFile) {
+                return;
+            }
+
+            Commit();
+#if defined(_WIN32)
+            CloseHandle(file);
+#else
+            close(file);
+#endif
+            file = NoFile;
+            pending.clear();
+        }
+
+        // queues rolls for the next sync, returning the sequence given to the last of them, or 0 if the journal isn't open
+        //-- safe to call from any thread; the rolls are only durable once a Commit() covering them returns true
+        std::uint64_t Append(std::span<const Entry> entries) {
+            std::lock_guard const lock(mutex);
+            if (file == NoFile) {
+                return 0u;
+            }
+
+            size_t offset = pending.size();
+            pending.resize(offset + entries.size() * JournalRecord::Size);
+            for (Entry const& entry : entries) {
+                JournalRecord const record = { ++lastSequence, entry.game, entry.lane, entry.pinCount };
+                record.Encode(pending.data() + offset);
+                offset += JournalRecord::Size;
+            }
+
+            return lastSequence;
+        }
+
+        // waits until every roll up to the given sequence is durable, syncing them itself if no other thread is already
+        //-- returns false if a write or sync has failed, after which the journal takes no more commits
+        bool Commit(std::uint64_t sequence) {
+            std::unique_lock lock(mutex);
+            sequence = std::min(sequence, lastSequence);
+            while (durableSequence < sequence && !hasFailed) {
+                if (isSyncing) {
+                    synced.wait(lock);
+                    continue;
+                }
+
+                // lead a sync of everything appended so far, letting other threads append to a fresh buffer meanwhile
+                isSyncing = true;
+                std::swap(pending, writing);
+                std::uint64_t const syncedSequence = lastSequence;
+                lock.unlock();
+
+                bool const isWritten = WriteAndSync(writing);
+                writing.clear();
+
+                lock.lock();
+                isSyncing = false;
+                hasFailed = !isWritten;
+                durableSequence = isWritten ? syncedSequence : durableSequence;
+                syncs++;
+                synced.notify_all();
+            }
+
+            return durableSequence >= sequence;
+        }
+
+        // commits every roll appended so far
+        bool Commit() {
+            return Commit(GetLastSequence());
+        }
+
+        std::uint64_t GetLastSequence() const {
+            std::lock_guard const lock(mutex);
+            return lastSequence;
+        }
+
+        std::uint64_t GetDurableSequence() const {
+            std::lock_guard const lock(mutex);
+            return durableSequence;
+        }
+
+        // how many syncs the journal has issued since it was opened, which group commit keeps well below the rolls
+        std::uint64_t GetSyncCount() const {
+            std::lock_guard const lock(mutex);
+            return syncs;
+        }
+
+        bool HasFailed() const {
+            std::lock_guard const lock(mutex);
+            return hasFailed;
+        }
+
+    private:
+        bool WriteAndSync(std::span<const std::uint8_t> bytes) {
+#if defined(_WIN32)
+            while (!bytes.empty()) {
+                DWORD written = 0u;
+                if (WriteFile(file, bytes.data(), static_cast<DWORD>(std::min<size_t>(bytes.size(), 1u << 30u)), &written, nullptr) == 0) {
+                    return false;
+                }
+                bytes = bytes.subspan(written);
+            }
+
+            return FlushFileBuffers(file) != 0;
+#else
+            while (!bytes.empty()) {
+                ssize_t const written = write(file, bytes.data(), bytes.size());
+                if (written < 0 && errno != EINTR) {
+                    return false;
+                }
+                if (written < 0) {
+                    continue;
+                }
+                bytes = bytes.subspan(static_cast<size_t>(written));
+            }
+
+#if defined(__linux__)
+            return fdatasync(file) == 0; // the file's size changes with every sync, so this still syncs its metadata
+#else
+            return fsync(file) == 0;
+#endif
+#endif
+        }
+    };
+} // namespace ExperisBowling
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <optional>
+#include "Game.hpp"
+#include <string_view>
+
+namespace ExperisBowling {
+    // Turns the scoreboard notation of a roll into its pin count: digits, 'x' for a strike, '/' for a spare and '-' for a gutter ball.
+    //-- a spare depends on the first roll of its frame, so the parser tracks which rolls pair up into frames
+    class RollNotationParser {
+    private:
+        unsigned    previousPins    = 0u;
+        bool        isFirstBall     = true;
+
+    public:
+        // forgets the frame in progress, ready for a new game
+        constexpr void Reset() {
+            previousPins = 0u;
+            isFirstBall = true;
+        }
+
+        // parses a single roll token, returning nothing if it isn't valid notation
+        //-- pin counts are not checked against the game here, that's left to Game::TryRoll()
+        constexpr std::optional<unsigned> Parse(std::string_view token) {
+            if (token.size() == 1u && !IsDigit(token[0])) {
+                return ParseSymbol(token[0]);
+            }
+            if (token.empty() || token.size() > 2u) {
+                return std::nullopt;
+            }
+
+            unsigned pins = 0u;
+            for (char c : token) {
+                if (!IsDigit(c)) {
+                    return std::nullopt;
+                }
+                pins = pins * 10u + static_cast<unsigned>(c - '0');
+            }
+
+            return Accept(pins);
+        }
+
+        // parses one of the single-character roll symbols
+        constexpr std::optional<unsigned> ParseSymbol(char symbol) {
+            switch (symbol) {
+            case 'x':
+            case 'X':
+                return Accept(Game::NumPins);
+            case '/':
+                if (isFirstBall) {
+                    return std::nullopt;
+                }
+                return Accept(Game::NumPins - previousPins);
+            case '-':
+                return Accept(0u);
+            default:
+                return std::nullopt;
+            }
+        }
+
+        // records a roll given as a plain pin count, so later spares know what they complete
+        constexpr unsigned Accept(unsigned pins) {
+            // a strike closes the frame on its own, anything else waits for a second ball
+            if (isFirstBall && pins < Game::NumPins) {
+                isFirstBall = false;
+                previousPins = pins;
+            }
+            else {
+                isFirstBall = true;
+            }
+
+            return pins;
+        }
+
+        static constexpr bool IsDigit(char c) {
+            return c >= '0' && c <= '9';
+        }
+    };
+} // namespace ExperisBowling
@@ -0,0 +1,245 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include "Archive.hpp"
+#include <cstdint>
+#include "Game.hpp"
+#include "MappedFile.hpp"
+#include <optional>
+#include <ostream>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace ExperisBowling {
+    // Layout of a binary roll stream archive, little-endian throughout:
+    //   header - RollStreamHeader::Size bytes, encoded as below
+    //   games  - per game, a roll count byte followed by its rolls packed two per byte, low nibble first
+    //   index  - optional, the file offset of every indexStride-th game as a uint64
+    struct RollStreamHeader {
+        static constexpr std::array<std::uint8_t, 4u>   Magic               = { 'E', 'B', 'R', 'S' };
+        static constexpr std::uint16_t                  CurrentVersion      = 1u;
+        static constexpr std::uint16_t                  HasIndexFlag        = 1u << 0u;
+        static constexpr size_t                         Size                = 32u;
+        static constexpr std::uint32_t                  DefaultIndexStride  = 16u;     // keeps the index tiny while lookups walk at most 15 records
+
+        std::uint16_t   version         = CurrentVersion;
+        std::uint16_t   flags           = 0u;
+        std::uint32_t   indexStride     = DefaultIndexStride;
+        std::uint64_t   gameCount       = 0u;
+        std::uint64_t   indexOffset     = 0u;       // 0 when the file has no index
+
+        // byte offsets of each field - bytes 12 to 15 are reserved
+        static constexpr size_t VersionOffset = 4u;
+        static constexpr size_t FlagsOffset = 6u;
+        static constexpr size_t IndexStrideOffset = 8u;
+        static constexpr size_t GameCountOffset = 16u;
+        static constexpr size_t IndexOffsetOffset = 24u;
+
+        template <class T>
+        static constexpr T LoadLittleEndian(std::uint8_t const* bytes) {
+            T value = 0u;
+            for (size_t i = 0u; i < sizeof(T); i++) {
+                value |= static_cast<T>(static_cast<T>(bytes[i]) << (8u * i));
+            }
+
+            return value;
+        }
+
+        template <class T>
+        static constexpr void StoreLittleEndian(std::uint8_t* bytes, T value) {
+            for (size_t i = 0u; i < sizeof(T); i++) {
+                bytes[i] = static_cast<std::uint8_t>(value >> (8u * i));
+            }
+        }
+
+        static constexpr bool HasMagic(std::span<const std::uint8_t> bytes) {
+            return bytes.size() >= Size && std::equal(Magic.begin(), Magic.end(), bytes.begin());
+        }
+
+        constexpr std::array<std::uint8_t, Size> Encode() const {
+            std::array<std::uint8_t, Size> bytes{};
+            std::copy(Magic.begin(), Magic.end(), bytes.begin());
+            StoreLittleEndian(bytes.data() + VersionOffset, version);
+            StoreLittleEndian(bytes.data() + FlagsOffset, flags);
+            StoreLittleEndian(bytes.data() + IndexStrideOffset, indexStride);
+            StoreLittleEndian(bytes.data() + GameCountOffset, gameCount);
+            StoreLittleEndian(bytes.data() + IndexOffsetOffset, indexOffset);
+
+            return bytes;
+        }
+
+        // reads a header, returning nothing if it isn't one we understand
+        static constexpr std::optional<RollStreamHeader> Decode(std::span<const std::uint8_t> bytes) {
+            if (!HasMagic(bytes)) {
+                return std::nullopt;
+            }
+
+            RollStreamHeader header;
+            header.version = LoadLittleEndian<std::uint16_t>(bytes.data() + VersionOffset);
+            header.flags = LoadLittleEndian<std::uint16_t>(bytes.data() + FlagsOffset);
+            header.indexStride = LoadLittleEndian<std::uint32_t>(bytes.data() + IndexStrideOffset);
+            header.gameCount = LoadLittleEndian<std::uint64_t>(bytes.data() + GameCountOffset);
+            header.indexOffset = LoadLittleEndian<std::uint64_t>(bytes.data() + IndexOffsetOffset);
+            if (header.version != CurrentVersion || header.indexStride == 0u) {
+                return std::nullopt;
+            }
+
+            return header;
+        }
+
+        // where the game records stop in a file of the given size, or nothing if its games and index can't fit in it
+        //-- every game takes at least its roll count byte, which also keeps the index size from overflowing
+        constexpr std::optional<size_t> GetDataEnd(size_t fileSize) const {
+            size_t dataEnd = fileSize;
+            if (flags & HasIndexFlag) {
+                if (indexOffset < Size || indexOffset > fileSize) {
+                    return std::nullopt;
+                }
+                dataEnd = static_cast<size_t>(indexOffset);
+            }
+            if (dataEnd < Size || gameCount > dataEnd - Size) {
+                return std::nullopt;
+            }
+
+            std::uint64_t const indexEntries = (gameCount + indexStride - 1u) / indexStride;
+            if ((flags & HasIndexFlag) && indexEntries > (fileSize - dataEnd) / sizeof(std::uint64_t)) {
+                return std::nullopt;
+            }
+
+            return dataEnd;
+        }
+    };
+
+    // rolls are stored as nibbles, so anything above this reads back as an invalid pin count
+    static constexpr std::uint8_t MaxPackedPins = 0xFu;
+
+    // writes an archive as a binary roll stream, optionally followed by an index for random access
+    template <GameArchive Archive>
+    bool WriteRollStream(std::ostream& out, Archive const& archive, bool withIndex = true) {
+        RollStreamHeader header;
+        header.gameCount = archive.GetGameCount();
+
+        std::array<std::uint8_t, RollStreamHeader::Size> const placeholder{};
+        out.write(reinterpret_cast<char const*>(placeholder.data()), placeholder.size());
+
+        std::vector<std::uint64_t> index;
+        std::uint64_t offset = RollStreamHeader::Size;
+        std::array<std::uint8_t, Game::MaxRolls + 1u> buffer;
+        std::array<std::uint8_t, 1u + (Game::MaxRolls + 2u) / 2u> record;
+
+        for (size_t game = 0u; game < header.gameCount; game++) {
+            if (game % header.indexStride == 0u) {
+                index.push_back(offset);
+            }
+
+            // anything longer than a game can be is invalid already, so there's no need to keep the excess
+            std::span<const std::uint8_t> const rolls = archive.GetGameRolls(game, buffer);
+            size_t const rollCount = std::min<size_t>(rolls.size(), Game::MaxRolls + 1u);
+            size_t const recordSize = 1u + (rollCount + 1u) / 2u;
+
+            record.fill(0u);
+            record[0] = static_cast<std::uint8_t>(rollCount);
+            for (size_t i = 0u; i < rollCount; i++) {
+                std::uint8_t const pins = std::min(rolls[i], MaxPackedPins);
+                record[1u + i / 2u] |= static_cast<std::uint8_t>(pins << (4u * (i % 2u)));
+            }
+
+            out.write(reinterpret_cast<char const*>(record.data()), static_cast<std::streamsize>(recordSize));
+            offset += recordSize;
+        }
+
+        if (withIndex) {
+            header.flags |= RollStreamHeader::HasIndexFlag;
+            header.indexOffset = offset;
+            for (std::uint64_t gameOffset : index) {
+                std::array<std::uint8_t, sizeof(std::uint64_t)> bytes;
+                RollStreamHeader::StoreLittleEndian(bytes.data(), gameOffset);
+                out.write(reinterpret_cast<char const*>(bytes.data()), bytes.size());
+            }
+        }
+
+        std::array<std::uint8_t, RollStreamHeader::Size> const headerBytes = header.Encode();
+        out.seekp(0);
+        out.write(reinterpret_cast<char const*>(headerBytes.data()), headerBytes.size());
+
+        return out.good();
+    }
+
+    // Zero-copy reader for a memory-mapped roll stream.
+    //-- rolls are unpacked straight from the mapping into the caller's buffer, which satisfies GameArchive
+    class RollStreamReader {
+    private:
+        MappedFile                  file;
+        RollStreamHeader            header;
+        size_t                      dataEnd = 0u;   // where the game records stop
+        std::vector<std::uint64_t>  builtIndex;     // only used when the file has no index of its own
+
+    public:
+        // takes over a mapped roll stream, returning nothing if its header or index is malformed
+        //-- files without an index get one built with a single pass over the record lengths
+        static std::optional<RollStreamReader> Open(MappedFile&& file) {
+            std::span<const std::uint8_t> const bytes = file.GetBytes();
+            std::optional<RollStreamHeader> const header = RollStreamHeader::Decode(bytes);
+            std::optional<size_t> const dataEnd = header ? header->GetDataEnd(bytes.size()) : std::nullopt;
+            if (!dataEnd) {
+                return std::nullopt;
+            }
+
+            RollStreamReader reader;
+            reader.header = *header;
+            reader.dataEnd = *dataEnd;
+
+            if (!(header->flags & RollStreamHeader::HasIndexFlag)) {
+                size_t offset = RollStreamHeader::Size;
+                reader.builtIndex.reserve(static_cast<size_t>((header->gameCount + header->indexStride - 1u) / header->indexStride));
+                for (std::uint64_t game = 0u; game < header->gameCount; game++) {
+                    if (offset >= reader.dataEnd) {
+                        return std::nullopt;
+                    }
+                    if (game % header->indexStride == 0u) {
+                        reader.builtIndex.push_back(offset);
+                    }
+                    offset += 1u + (bytes[offset] + 1u) / 2u;
+                }
+            }
+
+            reader.file = std::move(file);
+
+            return reader;
+        }
+
+        size_t GetGameCount() const {
+            return static_cast<size_t>(header.gameCount);
+        }
+
+        // unpacks a game's rolls into the buffer - a record that runs off the end of the data reads back as an invalid roll
+        std::span<const std::uint8_t> GetGameRolls(size_t index, std::span<std::uint8_t, Game::MaxRolls + 1u> buffer) const {
+            std::span<const std::uint8_t> const bytes = file.GetBytes();
+
+            // jump to the nearest indexed game, then skip over the records in between
+            size_t const indexEntry = index / header.indexStride;
+            size_t offset = builtIndex.empty()
+                ? static_cast<size_t>(RollStreamHeader::LoadLittleEndian<std::uint64_t>(bytes.data() + header.indexOffset + indexEntry * sizeof(std::uint64_t)))
+                : static_cast<size_t>(builtIndex[indexEntry]);
+            for (size_t skip = index % header.indexStride; skip > 0u && offset < dataEnd; skip--) {
+                offset += 1u + (bytes[offset] + 1u) / 2u;
+            }
+
+            size_t const rollCount = offset < dataEnd ? bytes[offset] : 0u;
+            if (offset >= dataEnd || rollCount > (dataEnd - offset - 1u) * 2u) {
+                buffer[0] = MaxPackedPins;
+                return buffer.first(1u);
+            }
+
+            size_t const keptRolls = std::min(rollCount, buffer.size());
+            std::uint8_t const* const packed = bytes.data() + offset + 1u;
+            for (size_t i = 0u; i < keptRolls; i++) {
+                buffer[i] = static_cast<std::uint8_t>((packed[i / 2u] >> (4u * (i % 2u))) & MaxPackedPins);
+            }
+
+            return buffer.first(keptRolls);
+        }
+    };
+} // namespace ExperisBowling
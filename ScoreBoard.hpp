@@ -0,0 +1,174 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include "Game.hpp"
+#include "Instrumentation.hpp"
+#include <span>
+#include <string_view>
+
+namespace ExperisBowling {
+    // Renders a game as the console scoreboard into a fixed-size character buffer.
+    //-- every frame row has the same width and the current-frame markers are the only lines that move,
+    //-- so the layout is fixed up front and rendering only ever writes characters in place
+    class ScoreBoard {
+    public:
+        static constexpr size_t RowLength = 48u;                // one frame, including its newline
+        static constexpr size_t MarkerLength = RowLength + 1u;  // the 'v'/'^' lines around the current frame
+        static constexpr size_t MaxLength = Game::FinalFrame * RowLength + 2u * MarkerLength;
+        static constexpr std::uint16_t AllFrames = (1u << Game::MaxFrames) - 1u;
+
+    private:
+        static constexpr unsigned NoFrame = Game::FinalFrame;   // markers are only drawn for the regular frames
+        static constexpr std::uint32_t NoRow = ~0u;             // forces a row to be rewritten
+
+        std::array<char, MaxLength>                     text            = {};
+        size_t                                          length          = 0u;
+        unsigned                                        markedFrame     = NoFrame;
+        std::array<std::uint32_t, Game::FinalFrame>     rowKeys         = MakeUnrenderedKeys();  // what each row currently shows
+
+    public:
+        // renders the whole board into a caller-provided buffer, returning how many characters were written
+        static constexpr size_t Render(Game const& game, std::span<char, MaxLength> out) {
+            EXPERIS_PROBE(Render);
+            unsigned const currentFrame = std::min(game.GetCurrentRoundIndex(), NoFrame);
+            for (unsigned i = 0u; i < Game::FinalFrame; i++) {
+                WriteRow(game, i, out.data() + GetRowOffset(i, currentFrame));
+            }
+            if (currentFrame != NoFrame) {
+                WriteMarkers(currentFrame, out.data());
+            }
+
+            return GetLength(currentFrame);
+        }
+
+        // redraws the board for the latest game state, rewriting only the rows that changed or moved since the last call
+        //-- changedFrames can narrow down which frames to look at, combining the RollResult masks of every roll since the last call
+        constexpr std::string_view Update(Game const& game, std::uint16_t changedFrames = AllFrames) {
+            EXPERIS_PROBE(Render);
+            // the final frame's row also shows the bonus rolls
+            unsigned const regularFrames = (1u << Game::FinalFrame) - 1u;
+            unsigned const changedRows = (changedFrames & regularFrames) | static_cast<unsigned>((changedFrames & ~regularFrames) != 0u) << (Game::FinalFrame - 1u);
+
+            unsigned const currentFrame = std::min(game.GetCurrentRoundIndex(), NoFrame);
+            for (unsigned i = 0u; i < Game::FinalFrame; i++) {
+                bool const hasMoved = GetRowOffset(i, currentFrame) != GetRowOffset(i, markedFrame);
+                if (!hasMoved && (changedRows >> i & 1u) == 0u && rowKeys[i] != NoRow) {
+                    continue;
+                }
+
+                std::uint32_t const key = GetRowKey(game, i);
+                if (key != rowKeys[i] || hasMoved) {
+                    WriteRow(game, i, text.data() + GetRowOffset(i, currentFrame));
+                    rowKeys[i] = key;
+                }
+            }
+            if (currentFrame != markedFrame && currentFrame != NoFrame) {
+                WriteMarkers(currentFrame, text.data());
+            }
+
+            markedFrame = currentFrame;
+            length = GetLength(currentFrame);
+
+            return GetText();
+        }
+
+        // the board as of the last Update()
+        constexpr std::string_view GetText() const {
+            return { text.data(), length };
+        }
+
+    private:
+        static constexpr std::array<std::uint32_t, Game::FinalFrame> MakeUnrenderedKeys() {
+            std::array<std::uint32_t, Game::FinalFrame> keys;
+            keys.fill(NoRow);
+
+            return keys;
+        }
+
+        // rows after a marker line are pushed down by it
+        static constexpr size_t GetRowOffset(unsigned frame, unsigned currentFrame) {
+            size_t offset = frame * RowLength;
+            if (currentFrame != NoFrame && frame >= currentFrame) {
+                offset += MarkerLength;
+            }
+            if (currentFrame != NoFrame && frame > currentFrame) {
+                offset += MarkerLength;
+            }
+
+            return offset;
+        }
+
+        static constexpr size_t GetLength(unsigned currentFrame) {
+            return currentFrame != NoFrame ? MaxLength : MaxLength - 2u * MarkerLength;
+        }
+
+        // packs everything a row displays, so unchanged rows can be skipped
+        static constexpr std::uint32_t GetRowKey(Game const& game, unsigned frame) {
+            Game::Frame const info = game.GetFrame(frame);
+            unsigned const bonusPins = frame == Game::FinalFrame - 1u ? game.GetFrame(frame + 1u).pinsOnFirstRoll.value_or(0u) : 0u;
+
+            return static_cast<std::uint32_t>(info.isStrike) | static_cast<std::uint32_t>(info.isSpare) << 1u
+                | info.pinsOnFirstRoll.value_or(0u) << 2u | info.pinsOnSecondRoll.value_or(0u) << 6u
+                | info.currentScore << 10u | info.totalScore << 19u | bonusPins << 28u;
+        }
+
+        // right-aligns a number in a field of the given width, like std::setw()
+        static constexpr char* WriteNumber(char* out, unsigned value, size_t width) {
+            for (size_t i = width; i-- > 0u;) {
+                out[i] = value > 0u || i == width - 1u ? static_cast<char>('0' + value % 10u) : ' ';
+                value /= 10u;
+            }
+
+            return out + width;
+        }
+
+        static constexpr char* WriteText(char* out, std::string_view text) {
+            return std::copy(text.begin(), text.end(), out);
+        }
+
+        // e.g. "Round  1 - [ 8,  /]    Current:  15, Total:  15\n"
+        static constexpr void WriteRow(Game const& game, unsigned frame, char* out) {
+            Game::Frame const info = game.GetFrame(frame);
+
+            out = WriteText(out, "Round ");
+            out = WriteNumber(out, frame + 1u, 2u);
+            out = WriteText(out, " - [");
+
+            if (info.isStrike) {
+                out = WriteText(out, " X,  _");
+            }
+            else {
+                out = WriteNumber(out, info.pinsOnFirstRoll.value_or(0u), 2u);
+                out = WriteText(out, ", ");
+                out = info.isSpare ? WriteText(out, " /") : WriteNumber(out, info.pinsOnSecondRoll.value_or(0u), 2u);
+            }
+
+            if (frame == Game::FinalFrame - 1u) {
+                unsigned const pins = game.GetFrame(frame + 1u).pinsOnFirstRoll.value_or(0u);
+                out = WriteText(out, ", ");
+                out = pins == Game::NumPins ? WriteText(out, "X") : WriteNumber(out, pins, 1u);
+                out = WriteText(out, "] ");
+            }
+            else {
+                out = WriteText(out, "]    ");
+            }
+
+            out = WriteText(out, "Current: ");
+            out = WriteNumber(out, info.currentScore, 3u);
+            out = WriteText(out, ", Total: ");
+            out = WriteNumber(out, info.totalScore, 3u);
+            WriteText(out, "\n");
+        }
+
+        static constexpr void WriteMarkers(unsigned currentFrame, char* out) {
+            char* const above = out + currentFrame * RowLength;
+            char* const below = above + MarkerLength + RowLength;
+            std::fill_n(above, RowLength, 'v');
+            above[RowLength] = '\n';
+            std::fill_n(below, RowLength, '^');
+            below[RowLength] = '\n';
+        }
+    };
+} // namespace ExperisBowling
@@ -0,0 +1,437 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include "Game.hpp"
+#include "Instrumentation.hpp"
+#include "LaneManager.hpp"
+#include <optional>
+#include <span>
+
+namespace ExperisBowling {
+    // Layout of a scoring datagram, little-endian throughout:
+    //   header   - ScoringHeader::Size bytes: magic, version, command count, and a sequence number the reply echoes
+    //   commands - LaneCommand::Size bytes each, sent by a pinsetter controller
+    // a reply carries the same header, then one ScoreDelta per command, each followed by the frames that command changed
+    struct ScoringHeader {
+        static constexpr std::array<std::uint8_t, 2u>   Magic           = { 'E', 'B' };
+        static constexpr std::uint8_t                   CurrentVersion  = 1u;
+        static constexpr size_t                         Size            = 8u;
+        static constexpr size_t                         MaxCommands     = 48u;  // keeps a full reply inside one unfragmented datagram
+
+        std::uint8_t    version         = CurrentVersion;
+        std::uint8_t    commandCount    = 0u;
+        std::uint32_t   sequence        = 0u;
+
+        // byte offsets of each field - bytes 4 and 5 are reserved
+        static constexpr size_t VersionOffset = 2u;
+        static constexpr size_t CommandCountOffset = 3u;
+        static constexpr size_t SequenceOffset = 4u;
+
+        template <class T>
+        static constexpr T LoadLittleEndian(std::uint8_t const* bytes) {
+            T value = 0u;
+            for (size_t i = 0u; i < sizeof(T); i++) {
+                value |= static_cast<T>(static_cast<T>(bytes[i]) << (8u * i));
+            }
+
+            return value;
+        }
+
+        template <class T>
+        static constexpr void StoreLittleEndian(std::uint8_t* bytes, T value) {
+            for (size_t i = 0u; i < sizeof(T); i++) {
+                bytes[i] = static_cast<std::uint8_t>(value >> (8u * i));
+            }
+        }
+
+        constexpr void Encode(std::uint8_t* bytes) const {
+            std::copy(Magic.begin(), Magic.end(), bytes);
+            bytes[VersionOffset] = version;
+            bytes[CommandCountOffset] = commandCount;
+            StoreLittleEndian(bytes + SequenceOffset, sequence);
+        }
+
+        // reads a header, returning nothing if it isn't one we understand
+        static constexpr std::optional<ScoringHeader> Decode(std::span<const std::uint8_t> bytes) {
+            if (bytes.size() < Size || !std::equal(Magic.begin(), Magic.end(), bytes.begin()) || bytes[VersionOffset] != CurrentVersion) {
+                return std::nullopt;
+            }
+
+            ScoringHeader header;
+            header.commandCount = bytes[CommandCountOffset];
+            header.sequence = LoadLittleEndian<std::uint32_t>(bytes.data() + SequenceOffset);
+            if (header.commandCount > MaxCommands) {
+                return std::nullopt;
+            }
+
+            return header;
+        }
+
+        // reads a controller's header, also turning it away if the datagram is too short for the commands it claims
+        static constexpr std::optional<ScoringHeader> DecodeRequest(std::span<const std::uint8_t> bytes);
+    };
+
+    // what a pinsetter controller asks of a lane
+    enum class LaneCommandKind : std::uint8_t {
+        Roll,           // the bowler knocked down pinCount pins
+        AddBowler,      // appends a bowler to the lane's order, the bowler field is ignored
+        RemoveBowler,
+        ResetLane,      // starts every game on the lane over
+    };
+
+    struct LaneCommand {
+        static constexpr size_t Size = 4u;
+
+        LaneCommandKind     kind        = LaneCommandKind::Roll;
+        std::uint8_t        lane        = 0u;
+        std::uint8_t        bowler      = 0u;
+        std::uint8_t        pinCount    = 0u;
+
+        constexpr void Encode(std::uint8_t* bytes) const {
+            bytes[0] = static_cast<std::uint8_t>(kind);
+            bytes[1] = lane;
+            bytes[2] = bowler;
+            bytes[3] = pinCount;
+        }
+
+        static constexpr LaneCommand Decode(std::uint8_t const* bytes) {
+            return { static_cast<LaneCommandKind>(bytes[0]), bytes[1], bytes[2], bytes[3] };
+        }
+    };
+
+    // defined out of line, it needs the size of a command
+    constexpr std::optional<ScoringHeader> ScoringHeader::DecodeRequest(std::span<const std::uint8_t> bytes) {
+        std::optional<ScoringHeader> const header = Decode(bytes);
+        if (header && bytes.size() < Size + header->commandCount * LaneCommand::Size) {
+            return std::nullopt;
+        }
+
+        return header;
+    }
+
+    // how a command went
+    enum class CommandStatus : std::uint8_t {
+        Applied,
+        RollRejected,   // the game refused the roll, see the delta's roll error
+        NoSuchBowler,
+        LaneFull,
+        UnknownCommand,
+    };
+
+    // the state of a bowler's game after a command, sent back in place of the whole board
+    struct ScoreDelta {
+        static constexpr size_t Size = 12u;
+        static constexpr size_t FrameSize = 4u;         // frame index, its score and its running total
+        static constexpr size_t MaxFrames = 3u;         // a roll only ever changes its own frame and the two before it
+
+        std::uint8_t        lane                = 0u;
+        std::uint8_t        bowler              = 0u;
+        CommandStatus       status              = CommandStatus::Applied;
+        RollError           rollError           = RollError::None;
+        std::uint8_t        round               = 0u;
+        std::uint8_t        frameCount          = 0u;   // how many changed frames follow the delta
+        std::uint16_t       score               = 0u;
+        std::uint16_t       provisionalScore    = 0u;
+        std::uint16_t       maxPossibleScore    = 0u;
+    };
+
+    // the largest datagram either side ever sends
+    inline constexpr size_t MaxScoringDatagramSize = ScoringHeader::Size + ScoringHeader::MaxCommands * (ScoreDelta::Size + ScoreDelta::MaxFrames * ScoreDelta::FrameSize);
+
+    // one datagram's bytes, in a buffer that fits the largest of them
+    struct ScoringDatagram {
+        std::array<std::uint8_t, MaxScoringDatagramSize>    bytes   = {};
+        size_t                                              size    = 0u;
+
+        constexpr std::span<const std::uint8_t> GetBytes() const {
+            return std::span(bytes).first(size);
+        }
+    };
+
+    // how a controller's datagram compares to the last one it had applied
+    enum class DatagramAdmission : std::uint8_t {
+        New,        // later than anything the controller sent before, so it should be applied
+        Repeat,     // a resend of the last one, to be answered again without applying it
+        Stale,      // older than the last one, e.g. a resend overtaken by the next datagram, to be dropped
+    };
+
+    // Remembers the last datagram each controller had applied and the reply it got, so a resent datagram isn't applied twice.
+    //-- replies get lost and a controller resends whatever went unanswered, so sequence numbers have to go up with every
+    //-- new datagram, wrapping round, and keep going up across a controller's restarts
+    //-- controllers are told apart by an id the transport gives them, and the one heard from longest ago is forgotten to make room
+    template <size_t MaxControllers = 64u>
+    class ResendGuard {
+    private:
+        struct Controller {
+            std::uint64_t       id          = 0u;
+            std::uint64_t       lastHeard   = 0u;
+            std::uint32_t       sequence    = 0u;
+            ScoringDatagram     reply;              // empty until the last datagram's reply is remembered
+        };
+
+        std::array<Controller, MaxControllers>  controllers     = {};
+        size_t                                  controllerCount = 0u;
+        std::uint64_t                           clock           = 0u;
+
+    public:
+        // sorts a controller's datagram, taking a new one as the controller's last
+        constexpr DatagramAdmission Admit(std::uint64_t controller, ScoringHeader const& header) {
+            size_t index = Find(controller);
+            if (index == controllerCount) {
+                index = controllerCount < MaxControllers ? controllerCount++
+                    : static_cast<size_t>(std::min_element(controllers.begin(), controllers.end(), [](Controller const& a, Controller const& b) { return a.lastHeard < b.lastHeard; }) - controllers.begin());
+                controllers[index] = { controller, 0u, header.sequence - 1u, {} };
+            }
+            Controller& known = controllers[index];
+            known.lastHeard = ++clock;
+
+            // compared as a distance round the sequence space, so numbering can wrap
+            std::int32_t const distance = static_cast<std::int32_t>(header.sequence - known.sequence);
+            if (distance < 0) {
+                return DatagramAdmission::Stale;
+            }
+            if (distance == 0) {
+                return DatagramAdmission::Repeat;
+            }
+
+            known.sequence = header.sequence;
+            known.reply.size = 0u;
+            return DatagramAdmission::New;
+        }
+
+        // keeps the reply to a controller's last datagram, to answer resends of it with
+        constexpr void Remember(std::uint64_t controller, ScoringDatagram const& reply) {
+            size_t const index = Find(controller);
+            if (index < controllerCount && GetSequence(reply) == controllers[index].sequence) {
+                controllers[index].reply = reply;
+            }
+        }
+
+        // retrieves the reply a resent datagram should get again, or nothing if it's no longer known
+        constexpr ScoringDatagram const* FindReply(std::uint64_t controller, std::uint32_t sequence) const {
+            size_t const index = Find(controller);
+            return index < controllerCount && controllers[index].reply.size > 0u && GetSequence(controllers[index].reply) == sequence ? &controllers[index].reply : nullptr;
+        }
+
+    private:
+        // the index of a controller's entry, or controllerCount if it isn't known
+        constexpr size_t Find(std::uint64_t controller) const {
+            size_t index = 0u;
+            while (index < controllerCount && controllers[index].id != controller) {
+                index++;
+            }
+
+            return index;
+        }
+
+        static constexpr std::optional<std::uint32_t> GetSequence(ScoringDatagram const& reply) {
+            std::optional<ScoringHeader> const header = ScoringHeader::Decode(reply.GetBytes());
+            return header ? std::optional(header->sequence) : std::nullopt;
+        }
+    };
+
+    // Applies batches of controller datagrams to the lanes' games and builds the replies.
+    //-- the commands of a whole batch are grouped by lane before any are applied, so each lane's games are visited in one
+    //-- run while commands for the same lane keep their arrival order; nothing here allocates or touches a socket
+    template <size_t LaneCount = 48u, size_t MaxBowlersPerLane = 6u, size_t MaxBatch = 64u>
+    class ScoringService {
+    public:
+        using Lanes = LaneManager<LaneCount, MaxBowlersPerLane>;
+
+        static constexpr size_t MaxBatchDatagrams = MaxBatch;
+        static constexpr size_t MaxBatchCommands = MaxBatch * ScoringHeader::MaxCommands;
+
+        static_assert(LaneCount <= 256u && MaxBowlersPerLane <= 256u, "lanes and bowlers are addressed with a byte");
+
+    private:
+        struct AppliedCommand {
+            ScoreDelta                                                      delta;
+            std::array<std::uint8_t, ScoreDelta::MaxFrames * ScoreDelta::FrameSize>  frames  = {};
+        };
+
+        Lanes&                                              lanes;
+        std::array<LaneCommand, MaxBatchCommands>           commands        = {};
+        std::array<AppliedCommand, MaxBatchCommands>        applied         = {};
+        std::array<std::uint16_t, MaxBatchCommands>         laneOrder       = {};   // command indices grouped by lane
+        std::array<std::uint16_t, LaneCount + 1u>           laneStarts      = {};
+        std::array<std::uint16_t, MaxBatch>                 datagramStarts  = {};   // index of each datagram's first command
+        std::array<ScoringHeader, MaxBatch>                 headers         = {};
+        std::uint64_t                                       processed       = 0u;
+
+        static_assert(MaxBatchCommands <= UINT16_MAX, "command indices are stored as 16 bits");
+
+    public:
+        constexpr explicit ScoringService(Lanes& laneManager)
+            : lanes(laneManager) {
+        }
+
+        ScoringService(ScoringService const&) = delete;
+        ScoringService& operator=(ScoringService const&) = delete;
+
+        // answers every request of a batch, returning how many replies were written to the front of the reply span
+        //-- requests that aren't scoring datagrams get no reply, the rest get one in request order
+        constexpr size_t Process(std::span<const ScoringDatagram> requests, std::span<ScoringDatagram> replies) {
+            EXPERIS_NO_ALLOC_SCOPE();
+            size_t const datagramCount = std::min({ requests.size(), replies.size(), MaxBatch });
+
+            // decode every command, then count sort them by lane
+            size_t commandCount = 0u;
+            laneStarts.fill(0u);
+            for (size_t i = 0u; i < datagramCount; i++) {
+                std::span<const std::uint8_t> const bytes = requests[i].GetBytes();
+                std::optional<ScoringHeader> const header = ScoringHeader::DecodeRequest(bytes);
+                headers[i] = header.value_or(ScoringHeader{ 0u });
+                datagramStarts[i] = static_cast<std::uint16_t>(commandCount);
+                for (size_t c = 0u; header && c < header->commandCount; c++) {
+                    LaneCommand const command = LaneCommand::Decode(bytes.data() + ScoringHeader::Size + c * LaneCommand::Size);
+                    commands[commandCount++] = command;
+                    laneStarts[std::min<size_t>(command.lane, LaneCount)]++;
+                }
+            }
+
+            // commands for lanes that don't exist sort last
+            std::uint16_t start = 0u;
+            for (std::uint16_t& laneStart : laneStarts) {
+                std::uint16_t const count = laneStart;
+                laneStart = start;
+                start = static_cast<std::uint16_t>(start + count);
+            }
+            std::array<std::uint16_t, LaneCount + 1u> nextSlot = laneStarts;
+            for (size_t c = 0u; c < commandCount; c++) {
+                laneOrder[nextSlot[std::min<size_t>(commands[c].lane, LaneCount)]++] = static_cast<std::uint16_t>(c);
+            }
+
+            for (size_t i = 0u; i < commandCount; i++) {
+                size_t const c = laneOrder[i];
+                applied[c] = Apply(commands[c]);
+            }
+            processed += commandCount;
+
+            // replies go out in request order
+            size_t replyCount = 0u;
+            for (size_t i = 0u; i < datagramCount; i++) {
+                if (headers[i].version == 0u) {
+                    continue;
+                }
+
+                ScoringDatagram& reply = replies[replyCount++];
+                headers[i].Encode(reply.bytes.data());
+                reply.size = ScoringHeader::Size;
+                for (size_t c = datagramStarts[i]; c < datagramStarts[i] + headers[i].commandCount; c++) {
+                    reply.size += EncodeDelta(applied[c], reply.bytes.data() + reply.size);
+                }
+            }
+
+            return replyCount;
+        }
+
+        // how many commands have been applied since the service started
+        constexpr std::uint64_t GetProcessedCommands() const {
+            return processed;
+        }
+
+        // reads a reply delta back, returning the number of bytes it took, for controllers and tests
+        static constexpr size_t DecodeDelta(std::uint8_t const* bytes, ScoreDelta& delta) {
+            delta.lane = bytes[0];
+            delta.bowler = bytes[1];
+            delta.status = static_cast<CommandStatus>(bytes[2]);
+            delta.rollError = static_cast<RollError>(bytes[3]);
+            delta.round = bytes[4];
+            delta.frameCount = bytes[5];
+            delta.score = ScoringHeader::LoadLittleEndian<std::uint16_t>(bytes + 6u);
+            delta.provisionalScore = ScoringHeader::LoadLittleEndian<std::uint16_t>(bytes + 8u);
+            delta.maxPossibleScore = ScoringHeader::LoadLittleEndian<std::uint16_t>(bytes + 10u);
+
+            return ScoreDelta::Size + delta.frameCount * ScoreDelta::FrameSize;
+        }
+
+    private:
+        constexpr AppliedCommand Apply(LaneCommand const& command) {
+            EXPERIS_PROBE_LANE(command.lane);
+            AppliedCommand result;
+            result.delta.lane = command.lane;
+            result.delta.bowler = command.bowler;
+
+            switch (command.kind) {
+            case LaneCommandKind::Roll:
+                if (Game* const game = lanes.GetGame(command.lane, command.bowler)) {
+                    RollResult const roll = game->TryRoll(command.pinCount);
+                    result.delta.status = roll ? CommandStatus::Applied : CommandStatus::RollRejected;
+                    result.delta.rollError = roll.error;
+                    Describe(*game, roll.changedFrames, result);
+                }
+                else {
+                    result.delta.status = CommandStatus::NoSuchBowler;
+                }
+                break;
+
+            case LaneCommandKind::AddBowler:
+                if (std::optional<GameHandle> const handle = lanes.AddBowler(command.lane)) {
+                    result.delta.bowler = static_cast<std::uint8_t>(lanes.GetBowlerCount(command.lane) - 1u);
+                    Describe(*lanes.GetGame(command.lane, result.delta.bowler), 0u, result);
+                }
+                else {
+                    result.delta.status = CommandStatus::LaneFull;
+                }
+                break;
+
+            case LaneCommandKind::RemoveBowler:
+                result.delta.status = lanes.RemoveBowler(command.lane, command.bowler) ? CommandStatus::Applied : CommandStatus::NoSuchBowler;
+                break;
+
+            case LaneCommandKind::ResetLane:
+                lanes.ResetLane(command.lane);
+                result.delta.status = command.lane < LaneCount ? CommandStatus::Applied : CommandStatus::NoSuchBowler;
+                break;
+
+            default:
+                result.delta.status = CommandStatus::UnknownCommand;
+                break;
+            }
+
+            return result;
+        }
+
+        // fills in a game's scores and the regular frames a command changed, with bonus frames shown as the final one
+        static constexpr void Describe(Game const& game, std::uint16_t changedFrames, AppliedCommand& result) {
+            result.delta.round = static_cast<std::uint8_t>(game.GetCurrentRoundIndex());
+            result.delta.score = static_cast<std::uint16_t>(game.GetScore());
+            result.delta.provisionalScore = static_cast<std::uint16_t>(game.GetProvisionalScore());
+            result.delta.maxPossibleScore = static_cast<std::uint16_t>(game.GetMaxPossibleScore());
+
+            unsigned const regularFrames = (1u << Game::FinalFrame) - 1u;
+            unsigned const changedRows = (changedFrames & regularFrames) | static_cast<unsigned>((changedFrames & ~regularFrames) != 0u) << (Game::FinalFrame - 1u);
+            for (unsigned frame = 0u; frame < Game::FinalFrame && result.delta.frameCount < ScoreDelta::MaxFrames; frame++) {
+                if ((changedRows >> frame & 1u) == 0u) {
+                    continue;
+                }
+
+                Game::Frame const info = game.GetFrame(frame);
+                std::uint8_t* const bytes = result.frames.data() + result.delta.frameCount++ * ScoreDelta::FrameSize;
+                bytes[0] = static_cast<std::uint8_t>(frame);
+                bytes[1] = static_cast<std::uint8_t>(info.currentScore);
+                ScoringHeader::StoreLittleEndian(bytes + 2u, static_cast<std::uint16_t>(info.totalScore));
+            }
+        }
+
+        static constexpr size_t EncodeDelta(AppliedCommand const& command, std::uint8_t* bytes) {
+            ScoreDelta const& delta = command.delta;
+            bytes[0] = delta.lane;
+            bytes[1] = delta.bowler;
+            bytes[2] = static_cast<std::uint8_t>(delta.status);
+            bytes[3] = static_cast<std::uint8_t>(delta.rollError);
+            bytes[4] = delta.round;
+            bytes[5] = delta.frameCount;
+            ScoringHeader::StoreLittleEndian(bytes + 6u, delta.score);
+            ScoringHeader::StoreLittleEndian(bytes + 8u, delta.provisionalScore);
+            ScoringHeader::StoreLittleEndian(bytes + 10u, delta.maxPossibleScore);
+
+            size_t const frameBytes = delta.frameCount * ScoreDelta::FrameSize;
+            std::copy(command.frames.begin(), command.frames.begin() + frameBytes, bytes + ScoreDelta::Size);
+
+            return ScoreDelta::Size + frameBytes;
+        }
+    };
+} // namespace ExperisBowling
@@ -0,0 +1,321 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include "ScoringProtocol.hpp"
+#include <span>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#if defined(_MSC_VER)
+#pragma comment(lib, "Ws2_32.lib")
+#endif
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace ExperisBowling {
+    // Serves a ScoringService over UDP from one thread, answering every controller datagram with its score deltas.
+    //-- each wakeup drains every datagram already waiting, up to a batch, so a busy socket is answered a batch at a time
+    //-- and the service can group the whole batch by lane; an idle one is answered as soon as a single datagram lands
+    //-- the socket waits on epoll on Linux and WSAPoll on Windows, and the loop never allocates once the server is open
+    //-- a controller's resends of its last datagram are answered with the reply it already got, without applying it again
+    template <class Service>
+    class ScoringServer {
+    public:
+        static constexpr size_t MaxBatch = Service::MaxBatchDatagrams;
+        static constexpr int PollIntervalMs = 100; // how often Run() looks at its stop flag while the socket is idle
+
+    private:
+#if defined(_WIN32)
+        using Socket = SOCKET;
+        static constexpr Socket InvalidSocket = INVALID_SOCKET;
+#else
+        using Socket = int;
+        static constexpr Socket InvalidSocket = -1;
+#endif
+
+        // a batch of datagrams and who sent each of them
+        struct Batch {
+            std::array<ScoringDatagram, MaxBatch>   datagrams   = {};
+            std::array<sockaddr_storage, MaxBatch>  peers       = {};
+            std::array<socklen_t, MaxBatch>         peerSizes   = {};
+        };
+
+        // a request of the batch that repeats its controller's last datagram
+        struct Resend {
+            std::uint32_t   request     = 0u;
+            std::uint32_t   sequence    = 0u;
+        };
+
+        Service&                        service;
+        Socket                          socket      = InvalidSocket;
+#if !defined(_WIN32)
+        int                             poller      = -1;
+#endif
+        std::unique_ptr<Batch>          requests;
+        std::unique_ptr<Batch>          replies;
+        std::unique_ptr<ResendGuard<>>  resendGuard;
+        std::array<Resend, MaxBatch>    resends     = {};
+        std::uint64_t                   datagrams   = 0u;
+
+    public:
+        explicit ScoringServer(Service& scoringService)
+            : service(scoringService) {
+        }
+
+        ScoringServer(ScoringServer const&) = delete;
+        ScoringServer& operator=(ScoringServer const&) = delete;
+
+        ~ScoringServer() {
+            Close();
+        }
+
+        // binds to the given port on every interface, returning false if the socket can't be set up
+        //-- port 0 picks any free port, which GetPort() then reports
+        bool Open(std::uint16_t port) {
+            Close();
+            requests = std::make_unique<Batch>();
+            replies = std::make_unique<Batch>();
+            resendGuard = std::make_unique<ResendGuard<>>();
+
+#if defined(_WIN32)
+            WSADATA data;
+            if (WSAStartup(MAKEWORD(2, 2), &data) != 0) {
+                return false;
+            }
+#endif
+
+            socket = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+            if (socket == InvalidSocket) {
+                Close();
+                return false;
+            }
+
+            sockaddr_in address = {};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_ANY);
+            address.sin_port = htons(port);
+
+#if defined(_WIN32)
+            u_long nonBlocking = 1u;
+            bool const isOpen = bind(socket, reinterpret_cast<sockaddr const*>(&address), sizeof(address)) == 0
+                && ioctlsocket(socket, FIONBIO, &nonBlocking) == 0;
+#else
+            epoll_event event = {};
+            event.events = EPOLLIN;
+            poller = epoll_create1(0);
+            bool const isOpen = bind(socket, reinterpret_cast<sockaddr const*>(&address), sizeof(address)) == 0
+                && fcntl(socket, F_SETFL, fcntl(socket, F_GETFL) | O_NONBLOCK) == 0
+                && poller >= 0 && epoll_ctl(poller, EPOLL_CTL_ADD, socket, &event) == 0;
+#endif
+            if (!isOpen) {
+                Close();
+            }
+
+            return isOpen;
+        }
+
+        void Close() {
+            if (socket == InvalidSocket) {
+                return;
+            }
+
+#if defined(_WIN32)
+            closesocket(socket);
+            WSACleanup();
+#else
+            close(socket);
+            if (poller >= 0) {
+                close(poller);
+            }
+            poller = -1;
+#endif
+            socket = InvalidSocket;
+        }
+
+        // retrieves the port the server is bound to, or 0 if it isn't open
+        std::uint16_t GetPort() const {
+            sockaddr_in address = {};
+            socklen_t size = sizeof(address);
+            if (socket == InvalidSocket || getsockname(socket, reinterpret_cast<sockaddr*>(&address), &size) != 0) {
+                return 0u;
+            }
+
+            return ntohs(address.sin_port);
+        }
+
+        // serves datagrams until the flag is raised, which may come from another thread or a signal handler
+        void Run(std::atomic<bool> const& stopRequested) {
+            while (!stopRequested.load(std::memory_order_relaxed) && socket != InvalidSocket) {
+                ServeOnce(PollIntervalMs);
+            }
+        }
+
+        // waits up to the given time for datagrams, then answers every one already waiting, up to a batch
+        //-- returns how many datagrams were received
+        size_t ServeOnce(int timeoutMs) {
+            if (!Wait(timeoutMs)) {
+                return 0u;
+            }
+
+            size_t const received = Receive();
+            size_t const resendCount = HoldBackResends(received);
+            size_t replyCount = service.Process(std::span(requests->datagrams).first(received), replies->datagrams);
+
+            // the service skips requests it can't read, so match each reply back to the sender of the request it answers
+            for (size_t i = 0u, reply = 0u; i < received && reply < replyCount; i++) {
+                if (ScoringHeader::DecodeRequest(requests->datagrams[i].GetBytes())) {
+                    replies->peers[reply] = requests->peers[i];
+                    replies->peerSizes[reply] = requests->peerSizes[i];
+                    resendGuard->Remember(GetPeerId(requests->peers[i]), replies->datagrams[reply]);
+                    reply++;
+                }
+            }
+
+            // then answer the resends again, once the replies of any they repeat from this batch are remembered
+            for (size_t r = 0u; r < resendCount; r++) {
+                size_t const i = resends[r].request;
+                ScoringDatagram const* const reply = resendGuard->FindReply(GetPeerId(requests->peers[i]), resends[r].sequence);
+                if (reply != nullptr) {
+                    replies->datagrams[replyCount] = *reply;
+                    replies->peers[replyCount] = requests->peers[i];
+                    replies->peerSizes[replyCount] = requests->peerSizes[i];
+                    replyCount++;
+                }
+            }
+            Send(replyCount);
+            datagrams += received;
+
+            return received;
+        }
+
+        // how many datagrams have been received since the server started
+        std::uint64_t GetReceivedDatagrams() const {
+            return datagrams;
+        }
+
+    private:
+        // identifies a controller by the address and port it sends from
+        static std::uint64_t GetPeerId(sockaddr_storage const& peer) {
+            sockaddr_in const& address = reinterpret_cast<sockaddr_in const&>(peer);
+            return std::uint64_t{ ntohl(address.sin_addr.s_addr) } << 16u | ntohs(address.sin_port);
+        }
+
+        // empties every datagram that isn't new to its controller, so the service skips it, returning how many are resends
+        size_t HoldBackResends(size_t received) {
+            size_t resendCount = 0u;
+            for (size_t i = 0u; i < received; i++) {
+                ScoringDatagram& datagram = requests->datagrams[i];
+                std::optional<ScoringHeader> const header = ScoringHeader::DecodeRequest(datagram.GetBytes());
+                if (!header) {
+                    continue;
+                }
+
+                DatagramAdmission const admission = resendGuard->Admit(GetPeerId(requests->peers[i]), *header);
+                if (admission == DatagramAdmission::Repeat) {
+                    resends[resendCount++] = { static_cast<std::uint32_t>(i), header->sequence };
+                }
+                if (admission != DatagramAdmission::New) {
+                    datagram.size = 0u;
+                }
+            }
+
+            return resendCount;
+        }
+
+        bool Wait(int timeoutMs) {
+#if defined(_WIN32)
+            WSAPOLLFD descriptor = {};
+            descriptor.fd = socket;
+            descriptor.events = POLLRDNORM;
+            return WSAPoll(&descriptor, 1u, timeoutMs) > 0;
+#else
+            epoll_event event;
+            return epoll_wait(poller, &event, 1, timeoutMs) > 0;
+#endif
+        }
+
+        size_t Receive() {
+#if defined(_WIN32)
+            size_t received = 0u;
+            for (; received < MaxBatch; received++) {
+                ScoringDatagram& datagram = requests->datagrams[received];
+                int peerSize = sizeof(sockaddr_storage);
+                int const size = recvfrom(socket, reinterpret_cast<char*>(datagram.bytes.data()), static_cast<int>(datagram.bytes.size()), 0,
+                    reinterpret_cast<sockaddr*>(&requests->peers[received]), &peerSize);
+                if (size < 0) {
+                    break;
+                }
+                datagram.size = static_cast<size_t>(size);
+                requests->peerSizes[received] = peerSize;
+            }
+
+            return received;
+#else
+            std::array<iovec, MaxBatch> buffers;
+            std::array<mmsghdr, MaxBatch> messages = {};
+            for (size_t i = 0u; i < MaxBatch; i++) {
+                buffers[i] = { requests->datagrams[i].bytes.data(), requests->datagrams[i].bytes.size() };
+                messages[i].msg_hdr.msg_iov = &buffers[i];
+                messages[i].msg_hdr.msg_iovlen = 1u;
+                messages[i].msg_hdr.msg_name = &requests->peers[i];
+                messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+            }
+
+            int const received = recvmmsg(socket, messages.data(), MaxBatch, MSG_DONTWAIT, nullptr);
+            for (int i = 0; i < received; i++) {
+                requests->datagrams[i].size = messages[i].msg_len;
+                requests->peerSizes[i] = messages[i].msg_hdr.msg_namelen;
+            }
+
+            return received > 0 ? static_cast<size_t>(received) : 0u;
+#endif
+        }
+
+        // sends the first replies of the batch, dropping any the socket buffer has no room for
+        void Send(size_t replyCount) {
+#if defined(_WIN32)
+            for (size_t i = 0u; i < replyCount; i++) {
+                ScoringDatagram const& datagram = replies->datagrams[i];
+                sendto(socket, reinterpret_cast<char const*>(datagram.bytes.data()), static_cast<int>(datagram.size), 0,
+                    reinterpret_cast<sockaddr const*>(&replies->peers[i]), replies->peerSizes[i]);
+            }
+#else
+            std::array<iovec, MaxBatch> buffers;
+            std::array<mmsghdr, MaxBatch> messages = {};
+            for (size_t i = 0u; i < replyCount; i++) {
+                buffers[i] = { replies->datagrams[i].bytes.data(), replies->datagrams[i].size };
+                messages[i].msg_hdr.msg_iov = &buffers[i];
+                messages[i].msg_hdr.msg_iovlen = 1u;
+                messages[i].msg_hdr.msg_name = &replies->peers[i];
+                messages[i].msg_hdr.msg_namelen = replies->peerSizes[i];
+            }
+
+            for (size_t sent = 0u; sent < replyCount;) {
+                int const count = sendmmsg(socket, messages.data() + sent, static_cast<unsigned>(replyCount - sent), MSG_DONTWAIT);
+                if (count <= 0) {
+                    break;
+                }
+                sent += static_cast<size_t>(count);
+            }
+#endif
+        }
+    };
+} // namespace ExperisBowling
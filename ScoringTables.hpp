@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "Game.hpp"
+
+namespace ExperisBowling {
+    // Resolves bonus rolls through a transition table generated at compile time, instead of branching per frame.
+    //-- every (round, bonus rolls owed by the frame two back, bonus rolls owed by the previous frame) state is
+    //-- known ahead of time, so a roll only needs one lookup to know which frames it feeds and which it finalizes
+    struct TableScoring {
+        // what a roll does to the frame two back ("prior") and the previous frame ("prev")
+        struct BonusTransition {
+            std::uint8_t    priorAddsPins       = 0u;   // 1 if the roll counts towards the prior frame
+            std::uint8_t    priorBonusRolls     = 0u;   // bonus rolls the prior frame is owed afterwards
+            std::uint8_t    priorResolves       = 0u;   // 1 if the roll finalizes the prior frame's total
+            std::uint8_t    priorHasBase        = 0u;   // 0 if there's no frame before the prior one to add to
+            std::uint8_t    prevAddsPins        = 0u;
+            std::uint8_t    prevBonusRolls      = 0u;
+            std::uint8_t    prevResolves        = 0u;
+            std::uint8_t    prevHasBase         = 0u;
+            std::uint8_t    scoredPins          = 0u;   // how many times the roll counts towards the provisional score
+        };
+
+        // bonus counters are stored in 2 bits, so every value they can hold gets an entry
+        static constexpr unsigned BonusStates = 4u;
+
+        // one entry per round of a game with this many regular frames, followed by its two bonus frames
+        template <unsigned FinalFrame>
+        using TransitionTable = std::array<std::array<std::array<BonusTransition, BonusStates>, BonusStates>, FinalFrame + 2u>;
+
+        template <unsigned FinalFrame>
+        static consteval TransitionTable<FinalFrame> MakeTransitions() {
+            TransitionTable<FinalFrame> table{};
+            for (unsigned round = 0u; round < FinalFrame + 2u; round++) {
+                for (unsigned priorBonus = 0u; priorBonus < BonusStates; priorBonus++) {
+                    for (unsigned prevBonus = 0u; prevBonus < BonusStates; prevBonus++) {
+                        BonusTransition& transition = table[round][priorBonus][prevBonus];
+                        bool const feedsPrior = round >= 2u && priorBonus > 0u;
+                        bool const feedsPrev = round >= 1u && prevBonus > 0u;
+
+                        // frames that aren't fed keep their counters, which also covers the slots that don't exist yet
+                        transition.priorAddsPins = feedsPrior;
+                        transition.priorBonusRolls = static_cast<std::uint8_t>(feedsPrior ? priorBonus - 1u : priorBonus);
+                        transition.priorResolves = feedsPrior && priorBonus == 1u;
+                        transition.priorHasBase = round >= 3u;
+                        transition.prevAddsPins = feedsPrev;
+                        transition.prevBonusRolls = static_cast<std::uint8_t>(feedsPrev ? prevBonus - 1u : prevBonus);
+                        transition.prevResolves = feedsPrev && prevBonus == 1u;
+                        transition.prevHasBase = round >= 2u;
+
+                        // bonus frames don't count towards the score
+                        transition.scoredPins = static_cast<std::uint8_t>(feedsPrior + (feedsPrev && round - 1u < FinalFrame));
+                    }
+                }
+            }
+
+            return table;
+        }
+
+        // generated once for every frame count a game is played with
+        template <unsigned FinalFrame>
+        static const TransitionTable<FinalFrame> Transitions;
+
+        // frames before the first one wrap around onto the bonus frames, which are untouched this early in a game
+        //-- this keeps the lookups free of range checks, and the table never lets those frames change
+        template <unsigned MaxFrames>
+        static constexpr unsigned FramesBack(unsigned round, unsigned distance) {
+            return (round + MaxFrames - distance) % MaxFrames;
+        }
+
+        template <class Game>
+        static constexpr void ResolveBonuses(Game& game, unsigned pinCount) {
+            auto& frames = game.frames;
+            unsigned const currentRound = game.currentRound;
+            auto& priorFrame = frames[FramesBack<Game::MaxFrames>(currentRound, 2u)];
+            auto& prevFrame = frames[FramesBack<Game::MaxFrames>(currentRound, 1u)];
+            BonusTransition const& transition = Transitions<Game::FinalFrame>[currentRound][priorFrame.bonusRolls][prevFrame.bonusRolls];
+
+            priorFrame.currentScore += pinCount * transition.priorAddsPins;
+            priorFrame.bonusRolls = transition.priorBonusRolls;
+            if (transition.priorResolves) {
+                priorFrame.totalScore = frames[FramesBack<Game::MaxFrames>(currentRound, 3u)].totalScore * transition.priorHasBase + priorFrame.currentScore;
+                game.finalizedScore = static_cast<std::uint16_t>(priorFrame.totalScore);
+            }
+
+            prevFrame.currentScore += pinCount * transition.prevAddsPins;
+            prevFrame.bonusRolls = transition.prevBonusRolls;
+            if (transition.prevResolves) {
+                prevFrame.totalScore = priorFrame.totalScore * transition.prevHasBase + prevFrame.currentScore;
+                game.finalizedScore = static_cast<std::uint16_t>(prevFrame.totalScore);
+            }
+
+            game.provisionalScore += static_cast<std::uint16_t>(pinCount * transition.scoredPins);
+        }
+    };
+
+    // defined out of line, the generator can't run until TableScoring is complete
+    template <unsigned FinalFrame>
+    inline constexpr TableScoring::TransitionTable<FinalFrame> TableScoring::Transitions = TableScoring::MakeTransitions<FinalFrame>();
+
+    // the ten-pin game with table-driven bonus resolution
+    using TableGame = BasicGame<TenPinRules, TableScoring>;
+} // namespace ExperisBowling
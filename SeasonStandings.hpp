@@ -0,0 +1,193 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include "Game.hpp"
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace ExperisBowling {
+    // how a league turns averages into handicaps, e.g. 90% of the difference from a 220 basis
+    struct HandicapRules {
+        unsigned    basis       = 220u;
+        unsigned    percent     = 90u;
+        unsigned    minGames    = 3u;   // bowlers with fewer games get no handicap yet
+    };
+
+    // one bowler's line in the standings
+    struct Standing {
+        std::uint32_t   bowler          = 0u;
+        std::uint32_t   games           = 0u;
+        unsigned        average         = 0u;   // truncated, as leagues publish it
+        unsigned        handicap        = 0u;
+        unsigned        highGame        = 0u;
+        unsigned        highSeries      = 0u;
+        double          strikeRate      = 0.0;  // strikes per regular frame
+        double          spareRate       = 0.0;  // spares per regular frame that wasn't a strike
+    };
+
+    // Aggregates a season of completed games into per-bowler accumulators, keeping the standings ranked as games come in.
+    //-- every statistic is a column of its own, so a standings pass reads only the columns it needs instead of any game
+    //-- the columns live in one arena that's released at once when the season ends, rather than per allocation
+    //-- a game is reduced to a handful of counters as soon as it's added, so standings never go back to any game; they
+    //-- only re-sort the bowlers by those counters, and only once games have come in since the last time
+    template <class PlayedGame = Game>
+    class SeasonStandings {
+    public:
+        static constexpr unsigned GamesPerSeries = 3u;
+
+        using BowlerId = std::uint32_t;
+
+    private:
+        template <class T>
+        using Column = std::pmr::vector<T>;
+
+        HandicapRules                       rules;
+        std::pmr::monotonic_buffer_resource arena;
+
+        // the accumulators, one entry per bowler
+        Column<std::uint32_t>               games;
+        Column<std::uint64_t>               pins;
+        Column<std::uint16_t>               highGames;
+        Column<std::uint32_t>               highSeries;
+        Column<std::uint32_t>               seriesPins;     // pins in the series still being bowled
+        Column<std::uint8_t>                seriesGames;
+        Column<std::uint32_t>               strikes;
+        Column<std::uint32_t>               spares;
+        Column<std::uint32_t>               spareChances;
+
+        // bowlers by average from the highest, and where each bowler sits in that order
+        Column<BowlerId>                    ranking;
+        Column<std::uint32_t>               ranks;
+        bool                                isRankingStale  = false;
+
+    public:
+        // sizes the arena for the expected number of bowlers, which it can still grow past
+        explicit SeasonStandings(size_t expectedBowlers = 0u, HandicapRules const& handicapRules = {})
+            : rules(handicapRules)
+            , arena(expectedBowlers * BytesPerBowler + 1u)
+            , games(&arena), pins(&arena), highGames(&arena), highSeries(&arena), seriesPins(&arena), seriesGames(&arena)
+            , strikes(&arena), spares(&arena), spareChances(&arena), ranking(&arena), ranks(&arena) {
+            ForEachColumn([&](auto& column) { column.reserve(expectedBowlers); });
+        }
+
+        SeasonStandings(SeasonStandings const&) = delete;
+        SeasonStandings& operator=(SeasonStandings const&) = delete;
+
+        // adds a bowler with no games, who ranks last until they bowl one
+        BowlerId AddBowler() {
+            BowlerId const bowler = static_cast<BowlerId>(games.size());
+            ForEachColumn([](auto& column) { column.emplace_back(); });
+            ranking.back() = bowler;
+            ranks.back() = bowler;
+
+            return bowler;
+        }
+
+        // folds a bowler's completed game into their accumulators, returning false for unfinished games or unknown bowlers
+        bool AddGame(BowlerId bowler, PlayedGame const& game) {
+            if (bowler >= games.size() || !game.IsGameComplete()) {
+                return false;
+            }
+
+            unsigned const score = game.GetScore();
+            for (unsigned i = 0u; i < PlayedGame::FinalFrame; i++) {
+                typename PlayedGame::Frame const frame = game.GetFrame(i);
+                strikes[bowler] += frame.isStrike;
+                spares[bowler] += frame.isSpare;
+                spareChances[bowler] += !frame.isStrike;
+            }
+
+            games[bowler]++;
+            pins[bowler] += score;
+            highGames[bowler] = static_cast<std::uint16_t>(std::max<unsigned>(highGames[bowler], score));
+            seriesPins[bowler] += score;
+            if (++seriesGames[bowler] == GamesPerSeries) {
+                highSeries[bowler] = std::max(highSeries[bowler], seriesPins[bowler]);
+                seriesPins[bowler] = 0u;
+                seriesGames[bowler] = 0u;
+            }
+
+            isRankingStale = true;
+            return true;
+        }
+
+        size_t GetBowlerCount() const {
+            return games.size();
+        }
+
+        // the bowler's current line, or nothing for an unknown bowler
+        std::optional<Standing> GetStanding(BowlerId bowler) const {
+            if (bowler >= games.size()) {
+                return std::nullopt;
+            }
+
+            Standing standing;
+            standing.bowler = bowler;
+            standing.games = games[bowler];
+            standing.average = games[bowler] > 0u ? static_cast<unsigned>(pins[bowler] / games[bowler]) : 0u;
+            standing.handicap = games[bowler] >= rules.minGames && standing.average < rules.basis ? (rules.basis - standing.average) * rules.percent / 100u : 0u;
+            standing.highGame = highGames[bowler];
+            standing.highSeries = highSeries[bowler];
+            std::uint64_t const frames = std::uint64_t{ games[bowler] } * PlayedGame::FinalFrame;
+            standing.strikeRate = frames > 0u ? static_cast<double>(strikes[bowler]) / static_cast<double>(frames) : 0.0;
+            standing.spareRate = spareChances[bowler] > 0u ? static_cast<double>(spares[bowler]) / spareChances[bowler] : 0.0;
+
+            return standing;
+        }
+
+        // where the bowler ranks by average, from 0 for the highest
+        std::optional<std::uint32_t> GetRank(BowlerId bowler) {
+            Rerank();
+            return bowler < ranks.size() ? std::optional(ranks[bowler]) : std::nullopt;
+        }
+
+        // writes the top of the standings in rank order, returning how many lines were written
+        size_t GetStandings(std::span<Standing> out) {
+            Rerank();
+            size_t const count = std::min(out.size(), ranking.size());
+            for (size_t i = 0u; i < count; i++) {
+                out[i] = *GetStanding(ranking[i]);
+            }
+
+            return count;
+        }
+
+    private:
+        // a rough arena size per bowler, so a season sized up front fits in the first block
+        static constexpr size_t BytesPerBowler = 8u * sizeof(std::uint32_t) + sizeof(std::uint64_t) + sizeof(std::uint16_t) + sizeof(std::uint8_t);
+
+        template <class Body>
+        void ForEachColumn(Body&& body) {
+            body(games); body(pins); body(highGames); body(highSeries); body(seriesPins); body(seriesGames);
+            body(strikes); body(spares); body(spareChances); body(ranking); body(ranks);
+        }
+
+        // whether one bowler's average is higher than another's, without dividing, with ties going to whoever has bowled more
+        bool IsAhead(BowlerId bowler, BowlerId other) const {
+            std::uint64_t const left = pins[bowler] * games[other];
+            std::uint64_t const right = pins[other] * games[bowler];
+            if (left != right) {
+                return left > right;
+            }
+
+            return games[bowler] != games[other] ? games[bowler] > games[other] : bowler < other;
+        }
+
+        // puts the bowlers back in order of average, if any game has come in since they were last ranked
+        void Rerank() {
+            if (!isRankingStale) {
+                return;
+            }
+
+            std::sort(ranking.begin(), ranking.end(), [&](BowlerId bowler, BowlerId other) { return IsAhead(bowler, other); });
+            for (std::uint32_t rank = 0u; rank < ranking.size(); rank++) {
+                ranks[ranking[rank]] = rank;
+            }
+            isRankingStale = false;
+        }
+    };
+} // namespace ExperisBowling
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace ExperisBowling {
+    // Publishes a value from one writer to any number of readers, none of which ever block.
+    //-- the writer bumps a sequence number to odd before changing the value and back to even after, and readers
+    //-- retry whenever the number was odd or moved while they copied; the value lives in atomic words so copying it isn't a data race
+    template <class T>
+    class SeqlockCell {
+    public:
+        static_assert(std::is_trivially_copyable_v<T>, "the value is copied through raw words");
+
+    private:
+        static constexpr size_t WordCount = (sizeof(T) + sizeof(std::uint64_t) - 1u) / sizeof(std::uint64_t);
+
+        using Words = std::array<std::uint64_t, WordCount>;
+
+        std::atomic<std::uint64_t>                          sequence    = 0u;
+        std::array<std::atomic<std::uint64_t>, WordCount>   words       = {};
+
+    public:
+        // replaces the value - only one thread may ever store to a cell
+        void Store(T const& value) {
+            Words raw{};
+            std::memcpy(raw.data(), &value, sizeof(T));
+
+            std::uint64_t const start = sequence.load(std::memory_order_relaxed);
+            sequence.store(start + 1u, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            for (size_t i = 0u; i < WordCount; i++) {
+                words[i].store(raw[i], std::memory_order_relaxed);
+            }
+            sequence.store(start + 2u, std::memory_order_release);
+        }
+
+        // copies out the latest value, retrying until the copy wasn't interleaved with a store
+        T Load() const {
+            Words raw;
+            while (true) {
+                std::uint64_t const start = sequence.load(std::memory_order_acquire);
+                if ((start & 1u) == 0u) {
+                    for (size_t i = 0u; i < WordCount; i++) {
+                        raw[i] = words[i].load(std::memory_order_relaxed);
+                    }
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    if (sequence.load(std::memory_order_relaxed) == start) {
+                        break;
+                    }
+                }
+            }
+
+            T value;
+            std::memcpy(static_cast<void*>(&value), raw.data(), sizeof(T));
+            return value;
+        }
+
+        // how many times the value has been stored, which readers can use to skip redrawing an unchanged value
+        std::uint64_t GetVersion() const {
+            return sequence.load(std::memory_order_acquire) / 2u;
+        }
+    };
+} // namespace ExperisBowling
@@ -0,0 +1,367 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include "LeaderboardReplica.hpp"
+#include <memory>
+#include <optional>
+#include "ScoringProtocol.hpp"
+#include <span>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace ExperisBowling {
+    // where a lane's games are scored
+    struct ShardLocation {
+        std::uint16_t   node    = 0u;
+        std::uint16_t   core    = 0u;
+
+        constexpr bool operator==(ShardLocation const&) const = default;
+    };
+
+    // Decides which node scores each center, and which of that node's cores scores each of its lanes.
+    //-- a center goes to whichever node its rendezvous hash scores highest on, so every center sits on exactly one node,
+    //-- its controllers only ever talk to that node, and adding a node only moves the centers that now score highest there
+    //-- a center's lanes are dealt out across the node's cores in turn, starting at a core that depends on the center
+    class ShardMap {
+    private:
+        std::uint16_t   nodeCount;
+        std::uint16_t   coresPerNode;
+
+    public:
+        constexpr ShardMap(std::uint16_t nodes, std::uint16_t cores)
+            : nodeCount(std::max<std::uint16_t>(nodes, 1u)), coresPerNode(std::max<std::uint16_t>(cores, 1u)) {
+        }
+
+        constexpr std::uint16_t GetNodeCount() const {
+            return nodeCount;
+        }
+
+        constexpr std::uint16_t GetCoresPerNode() const {
+            return coresPerNode;
+        }
+
+        constexpr std::uint16_t GetNode(std::uint16_t center) const {
+            std::uint16_t best = 0u;
+            std::uint64_t bestWeight = 0u;
+            for (std::uint16_t node = 0u; node < nodeCount; node++) {
+                std::uint64_t const weight = GetWeight(center, node);
+                if (node == 0u || weight > bestWeight) {
+                    best = node;
+                    bestWeight = weight;
+                }
+            }
+
+            return best;
+        }
+
+        constexpr std::uint16_t GetCore(std::uint16_t center, std::uint8_t lane) const {
+            return static_cast<std::uint16_t>((center + lane) % coresPerNode);
+        }
+
+        constexpr ShardLocation Locate(std::uint16_t center, std::uint8_t lane) const {
+            return { GetNode(center), GetCore(center, lane) };
+        }
+
+    private:
+        // SplitMix64's finalizer over the center and node, so nearby ids still spread evenly
+        static constexpr std::uint64_t GetWeight(std::uint16_t center, std::uint16_t node) {
+            std::uint64_t value = (std::uint64_t{ center } << 16u | node) + 0x9e3779b97f4a7c15u;
+            value = (value ^ (value >> 30u)) * 0xbf58476d1ce4e5b9u;
+            value = (value ^ (value >> 27u)) * 0x94d049bb133111ebu;
+            return value ^ (value >> 31u);
+        }
+    };
+
+    // Serves the centers a ShardMap gives one node, with every core's lanes scored by a service of its own.
+    //-- each core's service runs on one thread pinned to that core, so a lane's games are only ever touched from there
+    //-- and stay in that core's cache; the thread calling Process() only splits batches up and puts the replies together
+    //-- controllers keep addressing lanes as their center numbers them, the router maps each one to a slot on its core's
+    //-- service and back, and commands for lanes it doesn't serve are answered as the service answers unknown lanes
+    //-- the replies carry the same score deltas an unsharded service sends, which can also feed a LeaderboardPublisher
+    template <class Service = ScoringService<>>
+    class ShardRouter {
+    public:
+        using Lanes = typename Service::Lanes;
+
+        static constexpr size_t MaxBatch = Service::MaxBatchDatagrams;
+        static constexpr size_t MaxBatchCommands = Service::MaxBatchCommands;
+        static constexpr std::uint8_t NoSlot = UINT8_MAX;  // never one of a service's lanes
+
+        static_assert(Lanes::Lanes < NoSlot, "a core needs a lane number it never serves");
+
+    private:
+        // where one of a center's lanes is scored
+        struct LaneSlot {
+            std::uint16_t   core    = 0u;
+            std::uint8_t    slot    = NoSlot;
+        };
+
+        struct CenterLanes {
+            std::uint16_t                   center  = 0u;
+            std::array<LaneSlot, 256u>      slots   = {};
+        };
+
+        // one core's lanes, and the batch it's working through
+        struct Core {
+            std::unique_ptr<Lanes>                              lanes;
+            std::unique_ptr<Service>                            service;
+            std::array<ScoringDatagram, MaxBatch>               requests    = {};
+            std::array<ScoringDatagram, MaxBatch>               replies     = {};
+            std::array<std::uint16_t, MaxBatchCommands>         deltaOffsets = {};  // where each command's delta starts in its reply
+            size_t                                              commandCount = 0u;
+            size_t                                              slotCount   = 0u;
+        };
+
+        // a command of the batch, and where it went
+        struct CommandRoute {
+            LaneCommand     command;
+            std::uint16_t   core    = 0u;
+            std::uint16_t   index   = 0u;   // its place among the commands its core was given
+        };
+
+        ShardMap                                        map;
+        std::uint16_t                                   node;
+        LeaderboardPublisher*                           publisher;
+        std::vector<CenterLanes>                        centers;
+        std::vector<std::unique_ptr<Core>>              cores;
+        std::unique_ptr<std::array<CommandRoute, MaxBatchCommands>>  routes = std::make_unique<std::array<CommandRoute, MaxBatchCommands>>();
+        std::array<ScoringHeader, MaxBatch>             headers     = {};
+
+        std::atomic<std::uint64_t>                      generation  = 0u;   // bumped to hand every core its share of a batch
+        std::atomic<unsigned>                           busyCores   = 0u;
+        std::atomic<bool>                               isStopping  = false;
+        std::vector<std::jthread>                       workers;
+
+    public:
+        // starts one thread per core the map gives a node, pinning the threads to the host's cores in turn
+        ShardRouter(ShardMap const& shardMap, std::uint16_t servedNode, LeaderboardPublisher* leaderboard = nullptr)
+            : map(shardMap), node(servedNode), publisher(leaderboard) {
+            cores.resize(map.GetCoresPerNode());
+            for (std::unique_ptr<Core>& core : cores) {
+                core = std::make_unique<Core>();
+                core->lanes = std::make_unique<Lanes>();
+                core->service = std::make_unique<Service>(*core->lanes);
+            }
+
+            unsigned const hostCores = std::max(std::thread::hardware_concurrency(), 1u);
+            workers.reserve(cores.size());
+            for (size_t core = 0u; core < cores.size(); core++) {
+                workers.emplace_back([this, core] { RunCore(core); });
+                PinThread(workers.back(), static_cast<unsigned>(core % hostCores));
+            }
+        }
+
+        ShardRouter(ShardRouter const&) = delete;
+        ShardRouter& operator=(ShardRouter const&) = delete;
+
+        ~ShardRouter() {
+            isStopping = true;
+            generation++;
+            generation.notify_all();
+            workers.clear(); // joins before the cores the workers use are destroyed
+        }
+
+        // starts serving a center's lanes, returning false if the map puts it on another node, it's already served,
+        //-- or its lanes don't fit in the slots its cores have left
+        bool AddCenter(std::uint16_t center, size_t laneCount) {
+            if (map.GetNode(center) != node || laneCount > 256u || FindCenter(center) != nullptr) {
+                return false;
+            }
+
+            std::vector<size_t> needed(cores.size(), 0u);
+            for (size_t lane = 0u; lane < laneCount; lane++) {
+                needed[map.GetCore(center, static_cast<std::uint8_t>(lane))]++;
+            }
+            for (size_t core = 0u; core < cores.size(); core++) {
+                if (cores[core]->slotCount + needed[core] > Lanes::Lanes) {
+                    return false;
+                }
+            }
+
+            CenterLanes& added = centers.emplace_back();
+            added.center = center;
+            for (size_t lane = 0u; lane < laneCount; lane++) {
+                std::uint16_t const core = map.GetCore(center, static_cast<std::uint8_t>(lane));
+                added.slots[lane] = { core, static_cast<std::uint8_t>(cores[core]->slotCount++) };
+            }
+
+            return true;
+        }
+
+        // answers a batch of requests, each from the center at the same place in centers, like ScoringService::Process()
+        //-- returns how many replies were written to the front of the reply span, requests that aren't scoring datagrams
+        //-- getting none; it mustn't be called from more than one thread at once
+        size_t Process(std::span<const std::uint16_t> requestCenters, std::span<const ScoringDatagram> requests, std::span<ScoringDatagram> replies) {
+            size_t const datagramCount = std::min({ requestCenters.size(), requests.size(), replies.size(), MaxBatch });
+
+            Split(requestCenters.first(datagramCount), requests.first(datagramCount));
+            RunCores();
+
+            size_t replyCount = 0u;
+            for (size_t i = 0u, c = 0u; i < datagramCount; i++) {
+                if (headers[i].version == 0u) {
+                    continue;
+                }
+
+                ScoringDatagram& reply = replies[replyCount++];
+                headers[i].Encode(reply.bytes.data());
+                reply.size = ScoringHeader::Size;
+                for (size_t const end = c + headers[i].commandCount; c < end; c++) {
+                    reply.size += CopyDelta(requestCenters[i], (*routes)[c], reply.bytes.data() + reply.size);
+                }
+            }
+            return replyCount;
+        }
+
+        // how many commands the cores have applied since the router started
+        std::uint64_t GetProcessedCommands() const {
+            std::uint64_t processed = 0u;
+            for (std::unique_ptr<Core> const& core : cores) {
+                processed += core->service->GetProcessedCommands();
+            }
+
+            return processed;
+        }
+
+        // where one of a center's lanes is scored on this node, or nothing if the router doesn't serve it
+        std::optional<ShardLocation> Locate(std::uint16_t center, std::uint8_t lane) const {
+            CenterLanes const* const lanes = FindCenter(center);
+            return lanes != nullptr && lanes->slots[lane].slot != NoSlot ? std::optional(ShardLocation{ node, lanes->slots[lane].core }) : std::nullopt;
+        }
+
+    private:
+        CenterLanes const* FindCenter(std::uint16_t center) const {
+            auto const lanes = std::find_if(centers.begin(), centers.end(), [&](CenterLanes const& served) { return served.center == center; });
+            return lanes != centers.end() ? &*lanes : nullptr;
+        }
+
+        // turns the batch's commands into datagrams for each core, in arrival order so every lane's commands keep theirs
+        //-- commands for lanes the router doesn't serve go to the first core with a lane number it never serves
+        void Split(std::span<const std::uint16_t> requestCenters, std::span<const ScoringDatagram> requests) {
+            for (std::unique_ptr<Core> const& core : cores) {
+                core->commandCount = 0u;
+            }
+
+            size_t commandCount = 0u;
+            for (size_t i = 0u; i < requests.size(); i++) {
+                std::span<const std::uint8_t> const bytes = requests[i].GetBytes();
+                std::optional<ScoringHeader> const header = ScoringHeader::DecodeRequest(bytes);
+                headers[i] = header.value_or(ScoringHeader{ 0u });
+
+                CenterLanes const* const lanes = header ? FindCenter(requestCenters[i]) : nullptr;
+                for (size_t c = 0u; header && c < header->commandCount; c++) {
+                    LaneCommand const command = LaneCommand::Decode(bytes.data() + ScoringHeader::Size + c * LaneCommand::Size);
+                    LaneSlot const slot = lanes != nullptr ? lanes->slots[command.lane] : LaneSlot{};
+
+                    Core& core = *cores[slot.core];
+                    size_t const index = core.commandCount++;
+                    LaneCommand routed = command;
+                    routed.lane = slot.slot;
+                    routed.Encode(core.requests[index / ScoringHeader::MaxCommands].bytes.data() + ScoringHeader::Size + index % ScoringHeader::MaxCommands * LaneCommand::Size);
+                    (*routes)[commandCount++] = { command, slot.core, static_cast<std::uint16_t>(index) };
+                }
+            }
+
+            // every core datagram is full but the last
+            for (std::unique_ptr<Core> const& core : cores) {
+                for (size_t d = 0u; d * ScoringHeader::MaxCommands < core->commandCount; d++) {
+                    std::uint8_t const count = static_cast<std::uint8_t>(std::min(ScoringHeader::MaxCommands, core->commandCount - d * ScoringHeader::MaxCommands));
+                    ScoringHeader{ ScoringHeader::CurrentVersion, count }.Encode(core->requests[d].bytes.data());
+                    core->requests[d].size = ScoringHeader::Size + count * LaneCommand::Size;
+                }
+            }
+        }
+
+        // hands every core its datagrams and waits until they've all been answered
+        void RunCores() {
+            busyCores.store(static_cast<unsigned>(cores.size()), std::memory_order_relaxed);
+            generation.fetch_add(1u, std::memory_order_release);
+            generation.notify_all();
+
+            for (unsigned busy = busyCores.load(std::memory_order_acquire); busy > 0u; busy = busyCores.load(std::memory_order_acquire)) {
+                busyCores.wait(busy, std::memory_order_acquire);
+            }
+        }
+
+        void RunCore(size_t self) {
+            std::uint64_t seenGeneration = 0u;
+            while (true) {
+                generation.wait(seenGeneration, std::memory_order_acquire);
+                seenGeneration = generation.load(std::memory_order_acquire);
+                if (isStopping) {
+                    return;
+                }
+
+                Core& core = *cores[self];
+                if (core.commandCount > 0u) {
+                    size_t const datagramCount = (core.commandCount + ScoringHeader::MaxCommands - 1u) / ScoringHeader::MaxCommands;
+                    core.service->Process(std::span(core.requests).first(datagramCount), core.replies);
+                    IndexDeltas(core, datagramCount);
+                }
+
+                if (busyCores.fetch_sub(1u, std::memory_order_acq_rel) == 1u) {
+                    busyCores.notify_all();
+                }
+            }
+        }
+
+        // finds where each command's delta starts, as deltas only differ in how many frames follow them
+        static void IndexDeltas(Core& core, size_t datagramCount) {
+            size_t index = 0u;
+            for (size_t d = 0u; d < datagramCount; d++) {
+                std::uint8_t const* const bytes = core.replies[d].bytes.data();
+                for (size_t offset = ScoringHeader::Size; index < core.commandCount && offset < core.replies[d].size; index++) {
+                    ScoreDelta delta;
+                    core.deltaOffsets[index] = static_cast<std::uint16_t>(offset);
+                    offset += Service::DecodeDelta(bytes + offset, delta);
+                }
+            }
+        }
+
+        // copies a command's delta into its reply with the lane numbered as the controller sent it, returning its size
+        size_t CopyDelta(std::uint16_t center, CommandRoute const& route, std::uint8_t* out) const {
+            Core const& core = *cores[route.core];
+            std::uint8_t const* const bytes = core.replies[route.index / ScoringHeader::MaxCommands].bytes.data() + core.deltaOffsets[route.index];
+
+            ScoreDelta delta;
+            size_t const size = Service::DecodeDelta(bytes, delta);
+            std::copy(bytes, bytes + size, out);
+            out[0] = route.command.lane;
+
+            if (publisher != nullptr) {
+                delta.lane = route.command.lane;
+                publisher->Observe(center, route.command, delta);
+            }
+
+            return size;
+        }
+
+        // keeps a core's thread on one of the host's cores, leaving it wherever the scheduler likes if that isn't possible
+        static void PinThread(std::jthread& thread, unsigned hostCore) {
+#if defined(_WIN32)
+            SetThreadAffinityMask(thread.native_handle(), DWORD_PTR{ 1u } << (hostCore % (8u * sizeof(DWORD_PTR))));
+#else
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(hostCore % CPU_SETSIZE, &cpus);
+            pthread_setaffinity_np(thread.native_handle(), sizeof(cpus), &cpus);
+#endif
+        }
+    };
+} // namespace ExperisBowling
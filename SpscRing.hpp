@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+
+namespace ExperisBowling {
+    // Bounded, lock-free queue between exactly one producer thread and one consumer thread.
+    //-- each side owns one index and only reads the other's, and the two indices sit on separate cache lines
+    //-- each side also caches the other's last index it saw, so it only touches the shared line once the cache runs out
+    template <class T, size_t Capacity>
+    class SpscRing {
+    public:
+        static_assert(Capacity > 0u && (Capacity & (Capacity - 1u)) == 0u, "capacity must be a power of two");
+        static_assert(std::is_trivially_copyable_v<T>, "elements are copied in and out without constructors");
+
+        static constexpr size_t CacheLineSize = 64u;
+
+    private:
+        static constexpr size_t IndexMask = Capacity - 1u;
+
+        // each index line is padded out explicitly, since MSVC warns (C4324) about padding an alignment specifier adds
+        static constexpr size_t IndexPadding = CacheLineSize - sizeof(std::atomic<size_t>) - sizeof(size_t);
+        static_assert(sizeof(std::array<T, Capacity>) % CacheLineSize == 0u, "the buffer should fill whole cache lines, so the ring needs no padding after it");
+
+        // indices only ever increase, wrapping into the buffer through IndexMask
+        alignas(CacheLineSize) std::atomic<size_t>  head            = 0u;   // next slot to pop, written by the consumer
+        size_t                                      cachedTail      = 0u;   // the consumer's latest view of tail
+        std::array<std::byte, IndexPadding>         headPadding     = {};
+        alignas(CacheLineSize) std::atomic<size_t>  tail            = 0u;   // next slot to push, written by the producer
+        size_t                                      cachedHead      = 0u;   // the producer's latest view of head
+        std::array<std::byte, IndexPadding>         tailPadding     = {};
+        alignas(CacheLineSize) std::array<T, Capacity> buffer       = {};
+
+    public:
+        // called by the producer; fails without blocking if the ring is full
+        bool TryPush(T const& value) {
+            size_t const position = tail.load(std::memory_order_relaxed);
+            if (position - cachedHead == Capacity) {
+                cachedHead = head.load(std::memory_order_acquire);
+                if (position - cachedHead == Capacity) {
+                    return false;
+                }
+            }
+
+            buffer[position & IndexMask] = value;
+            tail.store(position + 1u, std::memory_order_release);
+            return true;
+        }
+
+        // called by the consumer; returns nothing without blocking if the ring is empty
+        std::optional<T> TryPop() {
+            size_t const position = head.load(std::memory_order_relaxed);
+            if (position == cachedTail) {
+                cachedTail = tail.load(std::memory_order_acquire);
+                if (position == cachedTail) {
+                    return std::nullopt;
+                }
+            }
+
+            T const value = buffer[position & IndexMask];
+            head.store(position + 1u, std::memory_order_release);
+            return value;
+        }
+
+        static constexpr size_t GetCapacity() {
+            return Capacity;
+        }
+    };
+} // namespace ExperisBowling
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "Game.hpp"
+#include "Rescore.hpp"
+#include "RollNotation.hpp"
+#include <span>
+
+namespace ExperisBowling {
+    // Scores games from a text stream fed in arbitrary blocks, one game per line or per ';'.
+    //-- tokens are read a character at a time, so a roll split across two blocks is still read correctly
+    //-- and nothing is allocated per token
+    class StreamScorer {
+    private:
+        Game                game;
+        RollNotationParser  parser;
+        unsigned            pendingNumber   = 0u;       // digits read so far of a pin count
+        unsigned            pendingDigits   = 0u;
+        bool                hasRolls        = false;    // whether the current game has seen any input at all
+        bool                isValid         = true;     // cleared by the first unreadable or rejected roll
+
+    public:
+        // consumes a block of text, calling onGame(GameScore const&) for every game it finishes
+        template <class OnGame>
+        void Feed(std::span<const char> block, OnGame&& onGame) {
+            for (char c : block) {
+                if (RollNotationParser::IsDigit(c)) {
+                    pendingNumber = pendingNumber * 10u + static_cast<unsigned>(c - '0');
+                    pendingDigits++;
+                    continue;
+                }
+                FlushNumber();
+
+                switch (c) {
+                case '\n':
+                case ';':
+                    FinishGame(onGame);
+                    break;
+                case ' ':
+                case '\t':
+                case '\r':
+                case ',':
+                    break;
+                default:
+                    ApplyRoll(parser.ParseSymbol(c));
+                    break;
+                }
+            }
+        }
+
+        // ends the stream, reporting a final game that had no trailing separator
+        template <class OnGame>
+        void Finish(OnGame&& onGame) {
+            FlushNumber();
+            FinishGame(onGame);
+        }
+
+    private:
+        void FlushNumber() {
+            if (pendingDigits == 0u) {
+                return;
+            }
+
+            // anything longer than "10" can't be a pin count
+            ApplyRoll(pendingDigits <= 2u ? std::optional(parser.Accept(pendingNumber)) : std::nullopt);
+            pendingNumber = 0u;
+            pendingDigits = 0u;
+        }
+
+        void ApplyRoll(std::optional<unsigned> pins) {
+            hasRolls = true;
+            isValid = isValid && pins && game.TryRoll(*pins);
+        }
+
+        template <class OnGame>
+        void FinishGame(OnGame& onGame) {
+            if (hasRolls) { // blank lines aren't games
+                onGame(isValid ? ToGameScore(game) : GameScore{});
+            }
+
+            game = Game();
+            parser.Reset();
+            hasRolls = false;
+            isValid = true;
+        }
+    };
+} // namespace ExperisBowling
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace ExperisBowling {
+    // Persistent thread pool that runs parallel loops with range-based work stealing.
+    //-- every worker owns a contiguous range of indices and takes work from its front; once empty
+    //-- it steals the back half of another worker's range, so uneven chunks still balance out
+    class WorkStealingPool {
+    private:
+        static constexpr size_t CacheLineSize = 64u;
+
+        // a worker's remaining range of indices, packed as [begin, end) into one word so it can be CAS'd
+        //-- padded out to its line explicitly, since MSVC warns (C4324) about padding an alignment specifier adds
+        struct alignas(CacheLineSize) WorkRange {
+            std::atomic<std::uint64_t>                                                range   = 0u;
+            std::array<std::byte, CacheLineSize - sizeof(std::atomic<std::uint64_t>)> padding = {};
+        };
+        static_assert(sizeof(WorkRange) == CacheLineSize);
+
+        static constexpr std::uint64_t PackRange(std::uint32_t begin, std::uint32_t end) {
+            return (static_cast<std::uint64_t>(begin) << 32u) | end;
+        }
+
+        static constexpr std::uint32_t RangeBegin(std::uint64_t range) {
+            return static_cast<std::uint32_t>(range >> 32u);
+        }
+
+        static constexpr std::uint32_t RangeEnd(std::uint64_t range) {
+            return static_cast<std::uint32_t>(range);
+        }
+
+        std::unique_ptr<WorkRange[]>    ranges;                 // slot 0 belongs to the calling thread
+        std::atomic<std::uint64_t>      generation = 0u;        // bumped to start every parallel loop
+        std::atomic<unsigned>           activeWorkers = 0u;     // workers still inside the current loop
+        std::atomic<bool>               isStopping = false;
+
+        // the loop body currently being run, type-erased so workers don't need to be templates
+        void                            (*invokeBody)(void*, size_t) = nullptr;
+        void*                           body = nullptr;
+
+        std::vector<std::jthread>       workers;
+
+    public:
+        // creates the pool - the thread calling ParallelFor() always joins in, so it counts towards threadCount
+        explicit WorkStealingPool(unsigned threadCount = std::thread::hardware_concurrency()) {
+            threadCount = threadCount > 0u ? threadCount : 1u;
+            ranges = std::make_unique<WorkRange[]>(threadCount);
+
+            workers.reserve(threadCount - 1u);
+            for (unsigned i = 1u; i < threadCount; i++) {
+                workers.emplace_back([this, i] { RunWorker(i); });
+            }
+        }
+
+        WorkStealingPool(WorkStealingPool const&) = delete;
+        WorkStealingPool& operator=(WorkStealingPool const&) = delete;
+
+        ~WorkStealingPool() {
+            isStopping = true;
+            generation++;
+            generation.notify_all();
+            workers.clear(); // joins before the state the workers use is destroyed
+        }
+
+        // retrieves how many threads take part in each parallel loop
+        unsigned GetThreadCount() const {
+            return static_cast<unsigned>(workers.size()) + 1u;
+        }
+
+        // calls body(i) for every i in [0, count) across all threads, returning once every call has finished
+        //-- count must fit in 32 bits; split larger jobs into chunks
+        template <class Body>
+        void ParallelFor(size_t count, Body&& loopBody) {
+            if (count == 0u) {
+                return;
+            }
+
+            invokeBody = [](void* context, size_t index) { (*static_cast<std::remove_reference_t<Body>*>(context))(index); };
+            body = const_cast<void*>(static_cast<void const*>(std::addressof(loopBody)));
+
+            // hand every thread an even share up front; stealing evens out the rest
+            unsigned const threadCount = GetThreadCount();
+            for (unsigned i = 0u; i < threadCount; i++) {
+                std::uint32_t const begin = static_cast<std::uint32_t>(count * i / threadCount);
+                std::uint32_t const end = static_cast<std::uint32_t>(count * (i + 1u) / threadCount);
+                ranges[i].range.store(PackRange(begin, end), std::memory_order_relaxed);
+            }
+
+            activeWorkers.store(threadCount - 1u, std::memory_order_relaxed);
+            generation.fetch_add(1u, std::memory_order_release);
+            generation.notify_all();
+
+            RunLoop(0u);
+
+            // wait until no worker can still be touching the loop body
+            for (unsigned active = activeWorkers.load(std::memory_order_acquire); active > 0u; active = activeWorkers.load(std::memory_order_acquire)) {
+                activeWorkers.wait(active, std::memory_order_acquire);
+            }
+        }
+
+    private:
+        void RunWorker(unsigned self) {
+            std::uint64_t seenGeneration = 0u;
+            while (true) {
+                generation.wait(seenGeneration, std::memory_order_acquire);
+                seenGeneration = generation.load(std::memory_order_acquire);
+                if (isStopping) {
+                    return;
+                }
+
+                RunLoop(self);
+
+                if (activeWorkers.fetch_sub(1u, std::memory_order_acq_rel) == 1u) {
+                    activeWorkers.notify_all();
+                }
+            }
+        }
+
+        // works through our own range, then keeps stealing until every range is empty
+        void RunLoop(unsigned self) {
+            do {
+                for (std::optional<std::uint32_t> index = PopFront(self); index; index = PopFront(self)) {
+                    invokeBody(body, *index);
+                }
+            } while (Steal(self));
+        }
+
+        std::optional<std::uint32_t> PopFront(unsigned self) {
+            std::atomic<std::uint64_t>& own = ranges[self].range;
+            std::uint64_t range = own.load(std::memory_order_acquire);
+            while (RangeBegin(range) < RangeEnd(range)) {
+                if (own.compare_exchange_weak(range, PackRange(RangeBegin(range) + 1u, RangeEnd(range)), std::memory_order_acq_rel)) {
+                    return RangeBegin(range);
+                }
+            }
+
+            return std::nullopt;
+        }
+
+        // moves the back half of another thread's range into ours, returning false if there was nothing to take
+        bool Steal(unsigned self) {
+            unsigned const threadCount = GetThreadCount();
+            for (unsigned offset = 1u; offset < threadCount; offset++) {
+                std::atomic<std::uint64_t>& victim = ranges[(self + offset) % threadCount].range;
+                std::uint64_t range = victim.load(std::memory_order_acquire);
+                while (RangeBegin(range) < RangeEnd(range)) {
+                    std::uint32_t const begin = RangeBegin(range);
+                    std::uint32_t const end = RangeEnd(range);
+                    std::uint32_t const middle = begin + (end - begin) / 2u;
+                    if (victim.compare_exchange_weak(range, PackRange(begin, middle), std::memory_order_acq_rel)) {
+                        ranges[self].range.store(PackRange(middle, end), std::memory_order_release);
+                        return true;
+                    }
+                }
+            }
+
+            return false;
+        }
+    };
+} // namespace ExperisBowling